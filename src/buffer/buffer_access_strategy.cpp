@@ -0,0 +1,18 @@
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+#include "buffer/buffer_pool_manager.h"
+
+BufferAccessStrategy::BufferAccessStrategy(BufferPoolManager *bpm, size_t ring_size)
+    : bpm_(bpm), rings_(bpm->GetShardCount()) {
+  // a reader pins the next page before it unpins the current one, so every shard needs at least two frames
+  size_t capacity = std::max<size_t>(2, ring_size / rings_.size());
+  for (auto &ring : rings_) {
+    ring.capacity_ = capacity;
+  }
+}
+
+BufferAccessStrategy::~BufferAccessStrategy() {
+  bpm_->ReleaseStrategy(this);
+}
@@ -1,31 +1,157 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
+// read-ahead requests beyond this many are dropped, the reader is far enough behind already
+static constexpr size_t MAX_READ_AHEAD_REQUESTS = 8;
+
+// dirty pages the page cleaner writes back under one latch of a shard
+static constexpr size_t CLEANER_BATCH_PAGES = 8;
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_shards,
+                                     ReplacerType replacer_type)
+    : pool_size_(pool_size), disk_manager_(disk_manager), replacer_type_(replacer_type) {
+  ASSERT(pool_size_ > 0, "Buffer pool must have at least one frame.");
+  num_shards = std::max<size_t>(1, std::min(num_shards, pool_size_));
+  arena_ = new FrameArena(pool_size_);
+  // the descriptors are built in place, each one pointing at its frame in the arena
+  pages_ = static_cast<Page *>(::operator new(pool_size_ * sizeof(Page)));
   for (size_t i = 0; i < pool_size_; i++) {
-    free_list_.emplace_back(i);
+    new (pages_ + i) Page(arena_->GetFrame(i));
+  }
+  // the first pool_size_ % num_shards shards get one extra frame each
+  size_t first_frame = 0;
+  for (size_t i = 0; i < num_shards; i++) {
+    auto shard = new Shard;
+    shard->frames_ = pages_ + first_frame;
+    shard->num_frames_ = pool_size_ / num_shards + (i < pool_size_ % num_shards ? 1 : 0);
+    shard->replacer_ = CreateReplacer(shard->num_frames_);
+    shard->owners_.resize(shard->num_frames_, nullptr);
+    shard->reading_.resize(shard->num_frames_, 0);
+    for (size_t j = 0; j < shard->num_frames_; j++) {
+      shard->free_list_.emplace_back(j);
+    }
+    first_frame += shard->num_frames_;
+    shards_.push_back(shard);
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    FlushPage(page.first);
+  StopPageCleaner();
+  {
+    std::scoped_lock<mutex> lock(read_ahead_latch_);
+    read_ahead_stop_ = true;
+  }
+  read_ahead_cv_.notify_all();
+  if (read_ahead_.joinable()) {
+    read_ahead_.join();
+  }
+  FlushAllPages();
+  for (auto shard : shards_) {
+    delete shard->replacer_;
+    delete shard;
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    pages_[i].~Page();
+  }
+  ::operator delete(pages_);
+  delete arena_;
+}
+
+Replacer *BufferPoolManager::CreateReplacer(size_t num_frames) {
+  switch (replacer_type_) {
+    case ReplacerType::LRU:
+      return new LRUReplacer(num_frames);
+    case ReplacerType::LRUK:
+      return new LRUKReplacer(num_frames);
+    case ReplacerType::CLOCK:
+      return new CLOCKReplacer(num_frames);
+  }
+  throw std::logic_error("Unsupported replacer type.");
+}
+
+frame_id_t BufferPoolManager::TryToFindFreePage(Shard &shard, bool read_ahead) {
+  frame_id_t frame_id;
+  if (!shard.free_list_.empty()) {
+    frame_id = shard.free_list_.back();
+    shard.free_list_.pop_back();
+    return frame_id;
+  }
+  if (!shard.replacer_->Victim(&frame_id)) {
+    return INVALID_FRAME_ID;
+  }
+  EvictFrame(shard, frame_id, read_ahead);
+  return frame_id;
+}
+
+void BufferPoolManager::EvictFrame(Shard &shard, frame_id_t frame_id, bool read_ahead) {
+  Page &victim = shard.frames_[frame_id];
+  if (victim.page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  if (victim.is_dirty_) {
+    disk_manager_->WritePage(victim.page_id_, victim.data_, victim.compressed_);
+    victim.is_dirty_ = false;
+    shard.dirty_frames_--;
+    if (read_ahead) {
+      shard.read_ahead_writes_++;
+    } else {
+      shard.foreground_writes_++;
+    }
+  }
+  shard.page_table_.erase(victim.page_id_);
+  victim.page_id_ = INVALID_PAGE_ID;
+}
+
+frame_id_t BufferPoolManager::TryToFindRingPage(Shard &shard, size_t shard_index, BufferAccessStrategy *strategy,
+                                                bool read_ahead) {
+  auto &ring = strategy->rings_[shard_index];
+  if (ring.frames_.size() < ring.capacity_) {
+    frame_id_t frame_id = TryToFindFreePage(shard, read_ahead);
+    if (frame_id != INVALID_FRAME_ID) {
+      shard.owners_[frame_id] = strategy;
+      ring.frames_.push_back(frame_id);
+      return frame_id;
+    }
+  }
+  for (size_t i = 0; i < ring.frames_.size(); i++) {
+    frame_id_t frame_id = ring.frames_[ring.cursor_];
+    ring.cursor_ = (ring.cursor_ + 1) % ring.frames_.size();
+    if (shard.frames_[frame_id].pin_count_ == 0 && !shard.reading_[frame_id]) {
+      EvictFrame(shard, frame_id, read_ahead);
+      shard.replacer_->Remove(frame_id);
+      return frame_id;
+    }
+  }
+  return TryToFindFreePage(shard, read_ahead);
+}
+
+void BufferPoolManager::ReleaseStrategy(BufferAccessStrategy *strategy) {
+  CancelReadAhead(strategy);
+  for (size_t i = 0; i < shards_.size(); i++) {
+    Shard &shard = *shards_[i];
+    std::scoped_lock<mutex> lock(shard.latch_);
+    for (auto frame_id : strategy->rings_[i].frames_) {
+      shard.owners_[frame_id] = nullptr;
+      // pinned frames enter the replacer as soon as their last pin is dropped
+      if (shard.frames_[frame_id].pin_count_ == 0) {
+        shard.replacer_->Unpin(frame_id);
+      }
+    }
+    strategy->rings_[i].frames_.clear();
   }
-  delete[] pages_;
-  delete replacer_;
 }
 
 /**
  * TODO: Student Implement
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -33,95 +159,105 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-	if(page_table_.find(page_id) == page_table_.end()) //cant find the page
-	{
-		//choose a frame page
-		frame_id_t ffid; //free frame id
-		if(free_list_.size() > 0){    //firstly  free list
-			ffid = free_list_.back();   // or front()
-			free_list_.pop_back();
-		}else{   //no page in free_list_   find a victim in the replacer
-			bool success = replacer_->Victim(&ffid);
-			if(!success)       
-			{
-				printf("error in BufferPoolManger::FetchPage\n");
-				return nullptr;
-			}
-		}
-
-		//now we get a free frame page   
-		//firstly, check dirty
-		page_id_t pre_id = pages_[ffid].page_id_;
-		if(pages_[ffid].is_dirty_)
-		{  //for dirty frame_page, it should be written back
-			disk_manager_->WritePage(pre_id, pages_[ffid].data_);   //(page_id, data)
-		}
-
-		pages_[ffid].is_dirty_ = false;
-		pages_[ffid].ResetMemory();
-		pages_[ffid].page_id_ = page_id;
-
-		//updata the page table
-		page_table_.erase(pre_id);
-		page_table_[page_id] = ffid;
-
-		//read the page to the frame-page
-		disk_manager_->ReadPage(page_id, pages_[ffid].data_); 
-		replacer_->Pin(ffid);
-		pages_[ffid].pin_count_++; //unnecessary?
-		return pages_ + ffid;
-	}else{  //find the page in the buffer pool
-		frame_id_t frame_id = page_table_[page_id];
-		replacer_->Pin(frame_id); //PIn the page
-		pages_[frame_id].pin_count_++; //unnecessary?
-		return pages_+ frame_id;
-	}
+  size_t shard_index = GetShardIndex(page_id);
+  Shard &shard = *shards_[shard_index];
+  std::unique_lock<mutex> lock(shard.latch_);
+  auto it = FindPage(shard, lock, page_id);
+  if (it != shard.page_table_.end()) {
+    Page *page = shard.frames_ + it->second;
+    shard.replacer_->Pin(it->second);
+    page->pin_count_++;
+    shard.hits_++;
+    return page;
+  }
+  shard.misses_++;
+  frame_id_t frame_id =
+      strategy == nullptr ? TryToFindFreePage(shard) : TryToFindRingPage(shard, shard_index, strategy);
+  if (frame_id == INVALID_FRAME_ID) {
+    LOG(WARNING) << "All frames are pinned, can not fetch page " << page_id << endl;
+    return nullptr;
+  }
+  Page *page = shard.frames_ + frame_id;
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  page->compressed_ = disk_manager_->ReadPage(page_id, page->data_);
+  shard.page_table_[page_id] = frame_id;
+  shard.replacer_->Pin(frame_id);
+  return page;
 }
 
 /**
  * TODO: Student Implement
  */
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+Page *BufferPoolManager::NewPage(page_id_t &page_id, AllocationRun *run) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-	frame_id_t ffid;
-	
-	if(free_list_.size() > 0){    //firstly  free list
-		ffid = free_list_.back();   // or front()
-		free_list_.pop_back();
-	}else{   //no page in free_list_   find a victim in the replacer
-		bool success = replacer_->Victim(&ffid);
-		if(!success)      // all the frame page is pinned!! 
-		{
-			//printf("error in BufferPoolManger::FetchPage\n");
-			return nullptr;
-		}
-	}
-	//now we get a free frame page   
-	//firstly, check dirty
-	page_id = AllocatePage();
-	
-	page_id_t pre_id = pages_[ffid].page_id_;
-	if(pages_[ffid].is_dirty_)
-	{  //for dirty frame_page, it should be written back
-		disk_manager_->WritePage(pre_id, pages_[ffid].data_);   //(page_id, data)
-	}
-
-	pages_[ffid].is_dirty_ = false;
-	pages_[ffid].ResetMemory();
-	pages_[ffid].page_id_ = page_id;
-
-	//updata the page table
-	page_table_.erase(pre_id);
-	page_table_[page_id] = ffid;
-
-	replacer_->Pin(ffid);
-	pages_[ffid].pin_count_ = 1; //unnecessary?
-
-	return pages_ + ffid;
+  // The shard is only known once the page id is. A page id whose shard has no frame to spare is put aside and the
+  // next one is tried, consecutive page ids map to different shards, until one fits or every shard is found full.
+  page_id_t new_page_id = AllocatePage(run);
+  if (new_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = NewPageInShard(new_page_id);
+  if (page == nullptr && shards_.size() > 1) {
+    std::vector<page_id_t> put_aside;
+    std::vector<bool> full_shards(shards_.size(), false);
+    size_t num_full_shards = 0;
+    while (page == nullptr && new_page_id != INVALID_PAGE_ID) {
+      put_aside.push_back(new_page_id);
+      size_t shard_index = GetShardIndex(new_page_id);
+      if (!full_shards[shard_index]) {
+        full_shards[shard_index] = true;
+        num_full_shards++;
+      }
+      // free page ids may all map to full shards, the search gives up after a few rounds over the shards
+      if (num_full_shards == shards_.size() || put_aside.size() >= MAX_NEW_PAGE_ROUNDS * shards_.size()) {
+        break;
+      }
+      new_page_id = AllocatePage(run);
+      if (new_page_id != INVALID_PAGE_ID) {
+        page = NewPageInShard(new_page_id);
+      }
+    }
+    for (page_id_t unused_page_id : put_aside) {
+      DeallocatePage(unused_page_id);
+    }
+  } else if (page == nullptr) {
+    DeallocatePage(new_page_id);
+  }
+  if (page == nullptr) {
+    LOG(WARNING) << "All frames are pinned, can not create a new page" << endl;
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+Page *BufferPoolManager::NewPageInShard(page_id_t page_id) {
+  Shard &shard = GetShard(page_id);
+  std::unique_lock<mutex> lock(shard.latch_);
+  // a read-ahead that followed a stale chain may have cached the page id while it was free
+  auto it = FindPage(shard, lock, page_id);
+  if (it != shard.page_table_.end()) {
+    DropFrame(shard, it->second);
+  }
+  frame_id_t frame_id = TryToFindFreePage(shard);
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+  Page *page = shard.frames_ + frame_id;
+  page->ResetMemory();
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  page->compressed_ = false;
+  shard.page_table_[page_id] = frame_id;
+  shard.replacer_->Pin(frame_id);
+  return page;
 }
 
 /**
@@ -133,67 +269,170 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  if(page_table_.find(page_id) != page_table_.end())
-	{
-		frame_id_t ffid = page_table_[page_id];
-		if(pages_[ffid].pin_count_ > 0)
-			return false;
-		else{
-			page_table_.erase(page_id);
-			pages_[ffid].ResetMemory();
-			pages_[ffid].is_dirty_ = false;
-			DeallocatePage(page_id);
-
-			//add the frame page to free_list and erase it from the lru-list/map!!
-			replacer_->Pin(ffid);  //not necessary
-			free_list_.emplace_back(ffid);
-			return true;
-		}
-	}
-	else{
-		DeallocatePage(page_id);
-		return true;
-	}
+  Shard &shard = GetShard(page_id);
+  {
+    std::unique_lock<mutex> lock(shard.latch_);
+    auto it = FindPage(shard, lock, page_id);
+    if (it != shard.page_table_.end()) {
+      if (shard.frames_[it->second].pin_count_ > 0) {
+        return false;
+      }
+      DropFrame(shard, it->second);
+    }
+  }
+  DeallocatePage(page_id);
+  return true;
+}
+
+void BufferPoolManager::ReclaimSpace() {
+  // frames of free pages are dropped when the pages are deleted, so none of them is written back into the holes
+  disk_manager_->ReclaimSpace();
+}
+
+void BufferPoolManager::DropFrame(Shard &shard, frame_id_t frame_id) {
+  Page *page = shard.frames_ + frame_id;
+  shard.page_table_.erase(page->page_id_);
+  BufferAccessStrategy *owner = shard.owners_[frame_id];
+  if (owner != nullptr) {
+    // the frame leaves the ring it was loaded through
+    auto &ring = owner->rings_[GetShardIndex(page->page_id_)];
+    ring.frames_.erase(std::find(ring.frames_.begin(), ring.frames_.end(), frame_id));
+    ring.cursor_ = 0;
+    shard.owners_[frame_id] = nullptr;
+  }
+  if (page->is_dirty_) {
+    shard.dirty_frames_--;
+  }
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  page->compressed_ = false;
+  // take the frame out of the replacer before it goes back to the free list
+  shard.replacer_->Remove(frame_id);
+  shard.free_list_.emplace_back(frame_id);
 }
 
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-	if(page_table_.find(page_id) == page_table_.end())	
-		return false;
-	else{
-		frame_id_t ffid = page_table_[page_id];
-		
-		//set dirty and pin_count 
-		pages_[ffid].is_dirty_ |= is_dirty;
-		pages_[ffid].pin_count_--;
-		if(pages_[ffid].pin_count_ == 0)
-			replacer_->Unpin(ffid);   //no thread Pin the page,  the page should be put into LRU-list
-		return true;
-	}
+  Shard &shard = GetShard(page_id);
+  std::scoped_lock<mutex> lock(shard.latch_);
+  auto it = shard.page_table_.find(page_id);
+  if (it == shard.page_table_.end()) {
+    return false;
+  }
+  Page *page = shard.frames_ + it->second;
+  if (page->pin_count_ <= 0) {
+    return false;
+  }
+  if (is_dirty && !page->is_dirty_) {
+    page->is_dirty_ = true;
+    shard.dirty_frames_++;
+    // a shard that fills up with dirty pages should not wait for the cleaner's next round
+    if (cleaner_running_ && shard.dirty_frames_ > cleaner_high_dirty_ratio_ * shard.num_frames_) {
+      WakePageCleaner();
+    }
+  }
+  // frames of a strategy's ring stay out of the replacer
+  if (--page->pin_count_ == 0 && shard.owners_[it->second] == nullptr) {
+    shard.replacer_->Unpin(it->second);
+  }
+  return true;
 }
 
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  if(page_table_.find(page_id) == page_table_.end())
-	{ // the page is not in in the frame page table
-		return false;
-	}else{
-		frame_id_t ffid = page_table_[page_id];
-		disk_manager_->WritePage(page_id, pages_[ffid].data_);
-		pages_[ffid].is_dirty_ = false;
-		return true;
-	}
-}
-
-page_id_t BufferPoolManager::AllocatePage() {
-  int next_page_id = disk_manager_->AllocatePage();
+  Shard &shard = GetShard(page_id);
+  std::unique_lock<mutex> lock(shard.latch_);
+  auto it = FindPage(shard, lock, page_id);
+  if (it == shard.page_table_.end()) {
+    return false;
+  }
+  Page *page = shard.frames_ + it->second;
+  disk_manager_->WritePage(page_id, page->data_, page->compressed_);
+  if (page->is_dirty_) {
+    page->is_dirty_ = false;
+    shard.dirty_frames_--;
+  }
+  return true;
+}
+
+void BufferPoolManager::FlushAllPages() {
+  AsyncIO *io = AsyncIO::Create(disk_manager_);
+  vector<frame_id_t> frame_ids;
+  for (auto shard : shards_) {
+    std::unique_lock<mutex> lock(shard->latch_);
+    frame_ids.clear();
+    for (auto entry : shard->page_table_) {
+      // pages that are still being read ahead are not loaded yet, let alone changed
+      if (!shard->reading_[entry.second]) {
+        frame_ids.push_back(entry.second);
+      }
+    }
+    for (size_t i = 0; i < frame_ids.size(); i += io->GetQueueDepth()) {
+      WriteFrames(*shard, io, frame_ids.data() + i, std::min(io->GetQueueDepth(), frame_ids.size() - i));
+    }
+  }
+  delete io;
+  disk_manager_->FlushMetadata();
+}
+
+size_t BufferPoolManager::WriteFrames(Shard &shard, AsyncIO *io, const frame_id_t *frame_ids, size_t count) {
+  vector<AsyncIORequest> requests(count);
+  vector<AsyncIORequest *> pending(count);
+  vector<AsyncIORequest *> completed(count);
+  size_t queued = 0;
+  size_t written = 0;
+  for (size_t i = 0; i < count; i++) {
+    Page &page = shard.frames_[frame_ids[i]];
+    // compressed pages are written synchronously, AsyncIO only transfers whole pages
+    if (page.compressed_) {
+      disk_manager_->WritePage(page.page_id_, page.data_, true);
+      written++;
+      if (page.is_dirty_) {
+        page.is_dirty_ = false;
+        shard.dirty_frames_--;
+      }
+      continue;
+    }
+    AsyncIORequest &request = requests[queued];
+    request.is_write_ = true;
+    request.page_id_ = page.page_id_;
+    request.data_ = page.data_;
+    request.user_data_ = &page;
+    pending[queued++] = &request;
+  }
+  size_t submitted = 0;
+  while (submitted < queued || io->GetInFlight() > 0) {
+    submitted += io->Submit(pending.data() + submitted, queued - submitted);
+    size_t reaped = io->Reap(completed.data(), count, 1);
+    for (size_t i = 0; i < reaped; i++) {
+      auto *page = static_cast<Page *>(completed[i]->user_data_);
+      if (completed[i]->result_ != 0) {
+        continue;
+      }
+      written++;
+      if (page->is_dirty_) {
+        page->is_dirty_ = false;
+        shard.dirty_frames_--;
+      }
+    }
+  }
+  return written;
+}
+
+page_id_t BufferPoolManager::AllocatePage(AllocationRun *run) {
+  int next_page_id = run == nullptr ? disk_manager_->AllocatePage() : disk_manager_->AllocatePage(run);
   return next_page_id;
 }
 
+void BufferPoolManager::ReleaseAllocationRun(AllocationRun *run) {
+  disk_manager_->ReleaseRun(run);
+}
+
 void BufferPoolManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
   disk_manager_->DeAllocatePage(page_id);
 }
@@ -202,13 +441,268 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
   return disk_manager_->IsPageFree(page_id);
 }
 
+uint64_t BufferPoolManager::GetHitCount() {
+  uint64_t hits = 0;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    hits += shard->hits_;
+  }
+  return hits;
+}
+
+uint64_t BufferPoolManager::GetMissCount() {
+  uint64_t misses = 0;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    misses += shard->misses_;
+  }
+  return misses;
+}
+
+uint64_t BufferPoolManager::GetCleanerWriteCount() {
+  uint64_t writes = 0;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    writes += shard->cleaner_writes_;
+  }
+  return writes;
+}
+
+uint64_t BufferPoolManager::GetForegroundWriteCount() {
+  uint64_t writes = 0;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    writes += shard->foreground_writes_;
+  }
+  return writes;
+}
+
+void BufferPoolManager::StartPageCleaner(double low_dirty_ratio, double high_dirty_ratio, uint32_t interval_ms) {
+  std::scoped_lock<mutex> lock(cleaner_latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  cleaner_low_dirty_ratio_ = low_dirty_ratio;
+  cleaner_high_dirty_ratio_ = std::max(low_dirty_ratio, high_dirty_ratio);
+  cleaner_interval_ = std::chrono::milliseconds(interval_ms);
+  cleaner_stop_ = false;
+  cleaner_woken_ = false;
+  cleaner_ = std::thread(&BufferPoolManager::RunPageCleaner, this);
+  cleaner_running_ = true;
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  {
+    std::scoped_lock<mutex> lock(cleaner_latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_stop_ = true;
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_one();
+  cleaner_.join();
+}
+
+void BufferPoolManager::WakePageCleaner() {
+  {
+    std::scoped_lock<mutex> lock(cleaner_latch_);
+    cleaner_woken_ = true;
+  }
+  cleaner_cv_.notify_one();
+}
+
+void BufferPoolManager::RunPageCleaner() {
+  AsyncIO *io = AsyncIO::Create(disk_manager_, CLEANER_BATCH_PAGES);
+  std::unique_lock<mutex> lock(cleaner_latch_);
+  while (!cleaner_stop_) {
+    cleaner_cv_.wait_for(lock, cleaner_interval_, [this] { return cleaner_stop_ || cleaner_woken_; });
+    if (cleaner_stop_) {
+      break;
+    }
+    cleaner_woken_ = false;
+    // shard latches are never taken while holding cleaner_latch_, UnpinPage nests them the other way round
+    lock.unlock();
+    for (auto shard : shards_) {
+      CleanShard(*shard, io);
+    }
+    lock.lock();
+  }
+  lock.unlock();
+  delete io;
+}
+
+void BufferPoolManager::CleanShard(Shard &shard, AsyncIO *io) {
+  const auto low_watermark = static_cast<size_t>(cleaner_low_dirty_ratio_ * shard.num_frames_);
+  vector<frame_id_t> candidates;
+  {
+    std::scoped_lock<mutex> lock(shard.latch_);
+    if (shard.dirty_frames_ <= low_watermark) {
+      return;
+    }
+    candidates.resize(shard.replacer_->Size());
+    candidates.resize(shard.replacer_->PeekVictims(candidates.data(), candidates.size()));
+  }
+  frame_id_t batch[CLEANER_BATCH_PAGES];
+  for (size_t next = 0; next < candidates.size();) {
+    std::scoped_lock<mutex> lock(shard.latch_);
+    if (shard.dirty_frames_ <= low_watermark) {
+      return;
+    }
+    size_t count = 0;
+    size_t limit = std::min(CLEANER_BATCH_PAGES, shard.dirty_frames_ - low_watermark);
+    for (; next < candidates.size() && count < limit; next++) {
+      // the frame may have been pinned, evicted or written back since the candidates were taken
+      Page &page = shard.frames_[candidates[next]];
+      if (page.page_id_ == INVALID_PAGE_ID || page.pin_count_ > 0 || !page.is_dirty_ ||
+          shard.reading_[candidates[next]]) {
+        continue;
+      }
+      batch[count++] = candidates[next];
+    }
+    shard.cleaner_writes_ += WriteFrames(shard, io, batch, count);
+  }
+}
+
+unordered_map<page_id_t, frame_id_t>::iterator BufferPoolManager::FindPage(Shard &shard,
+                                                                           std::unique_lock<mutex> &lock,
+                                                                           page_id_t page_id) {
+  auto it = shard.page_table_.find(page_id);
+  while (it != shard.page_table_.end() && shard.reading_[it->second]) {
+    shard.read_done_.wait(lock);
+    it = shard.page_table_.find(page_id);
+  }
+  return it;
+}
+
+void BufferPoolManager::ReadAhead(page_id_t page_id, size_t count, NextPageIdFunc next_page_id,
+                                  BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID || count == 0) {
+    return;
+  }
+  {
+    std::scoped_lock<mutex> lock(read_ahead_latch_);
+    // a reader that asks again has moved on, so its request that did not start yet would only read pages behind it
+    if (strategy != nullptr) {
+      auto it = std::find_if(read_ahead_queue_.begin(), read_ahead_queue_.end(),
+                             [strategy](const ReadAheadRequest &request) { return request.strategy_ == strategy; });
+      if (it != read_ahead_queue_.end()) {
+        *it = {page_id, count, next_page_id, strategy};
+        return;
+      }
+    }
+    if (read_ahead_queue_.size() >= MAX_READ_AHEAD_REQUESTS) {
+      return;
+    }
+    read_ahead_queue_.push_back({page_id, count, next_page_id, strategy});
+    if (!read_ahead_.joinable()) {
+      read_ahead_ = std::thread(&BufferPoolManager::RunReadAhead, this);
+    }
+  }
+  read_ahead_cv_.notify_all();
+}
+
+void BufferPoolManager::RunReadAhead() {
+  std::unique_lock<mutex> lock(read_ahead_latch_);
+  while (true) {
+    read_ahead_cv_.wait(lock, [this] { return read_ahead_stop_ || !read_ahead_queue_.empty(); });
+    if (read_ahead_stop_) {
+      break;
+    }
+    ReadAheadRequest request = read_ahead_queue_.front();
+    read_ahead_queue_.pop_front();
+    read_ahead_busy_ = true;
+    read_ahead_strategy_ = request.strategy_;
+    read_ahead_cancel_ = false;
+    lock.unlock();
+    page_id_t page_id = request.page_id_;
+    for (size_t i = 0; i < request.count_ && page_id != INVALID_PAGE_ID; i++) {
+      if (read_ahead_cancel_ || read_ahead_stop_) {
+        break;
+      }
+      page_id = ReadAheadPage(page_id, request.next_page_id_, request.strategy_);
+    }
+    lock.lock();
+    read_ahead_busy_ = false;
+    read_ahead_strategy_ = nullptr;
+    read_ahead_cv_.notify_all();
+  }
+}
+
+page_id_t BufferPoolManager::ReadAheadPage(page_id_t page_id, NextPageIdFunc next_page_id,
+                                           BufferAccessStrategy *strategy) {
+  size_t shard_index = GetShardIndex(page_id);
+  Shard &shard = *shards_[shard_index];
+  std::unique_lock<mutex> lock(shard.latch_);
+  auto it = shard.page_table_.find(page_id);
+  if (it != shard.page_table_.end()) {
+    return next_page_id(shard.frames_ + it->second);
+  }
+  frame_id_t frame_id = strategy == nullptr ? TryToFindFreePage(shard, true)
+                                             : TryToFindRingPage(shard, shard_index, strategy, true);
+  if (frame_id == INVALID_FRAME_ID) {
+    return INVALID_PAGE_ID;
+  }
+  // the frame is published in the page table right away, but stays out of the replacer until the read is done
+  Page *page = shard.frames_ + frame_id;
+  page->page_id_ = page_id;
+  page->pin_count_ = 0;
+  page->is_dirty_ = false;
+  shard.page_table_[page_id] = frame_id;
+  shard.reading_[frame_id] = 1;
+  lock.unlock();
+  page->compressed_ = disk_manager_->ReadPage(page_id, page->data_);
+  page_id_t next = next_page_id(page);
+  lock.lock();
+  shard.reading_[frame_id] = 0;
+  shard.read_ahead_pages_++;
+  if (shard.owners_[frame_id] == nullptr) {
+    shard.replacer_->Unpin(frame_id);
+  }
+  shard.read_done_.notify_all();
+  return next;
+}
+
+void BufferPoolManager::CancelReadAhead(BufferAccessStrategy *strategy) {
+  std::unique_lock<mutex> lock(read_ahead_latch_);
+  read_ahead_queue_.erase(
+      std::remove_if(read_ahead_queue_.begin(), read_ahead_queue_.end(),
+                     [strategy](const ReadAheadRequest &request) { return request.strategy_ == strategy; }),
+      read_ahead_queue_.end());
+  if (read_ahead_busy_ && read_ahead_strategy_ == strategy) {
+    read_ahead_cancel_ = true;
+    read_ahead_cv_.wait(lock, [this, strategy] { return !read_ahead_busy_ || read_ahead_strategy_ != strategy; });
+  }
+}
+
+uint64_t BufferPoolManager::GetReadAheadCount() {
+  uint64_t pages = 0;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    pages += shard->read_ahead_pages_;
+  }
+  return pages;
+}
+
+uint64_t BufferPoolManager::GetReadAheadWriteCount() {
+  uint64_t writes = 0;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    writes += shard->read_ahead_writes_;
+  }
+  return writes;
+}
+
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
   bool res = true;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
-      res = false;
-      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+  for (auto shard : shards_) {
+    std::scoped_lock<mutex> lock(shard->latch_);
+    for (size_t i = 0; i < shard->num_frames_; i++) {
+      if (shard->frames_[i].pin_count_ != 0) {
+        res = false;
+        LOG(ERROR) << "page " << shard->frames_[i].page_id_ << " pin count:" << shard->frames_[i].pin_count_ << endl;
+      }
     }
   }
   return res;
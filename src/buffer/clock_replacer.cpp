@@ -0,0 +1,63 @@
+#include "buffer/clock_replacer.h"
+
+CLOCKReplacer::CLOCKReplacer(size_t num_pages)
+    : capacity(num_pages), in_replacer_(num_pages, 0), ref_bit_(num_pages, 0) {}
+
+CLOCKReplacer::~CLOCKReplacer() = default;
+
+bool CLOCKReplacer::Victim(frame_id_t *frame_id) {
+  if (size_ == 0) {
+    return false;
+  }
+  // at most two sweeps: the first one may only clear reference bits
+  while (true) {
+    size_t current = hand_;
+    hand_ = (hand_ + 1) % capacity;
+    if (!in_replacer_[current]) {
+      continue;
+    }
+    if (ref_bit_[current]) {
+      ref_bit_[current] = 0;
+      continue;
+    }
+    in_replacer_[current] = 0;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(current);
+    return true;
+  }
+}
+
+void CLOCKReplacer::Pin(frame_id_t frame_id) {
+  ASSERT(static_cast<size_t>(frame_id) < capacity, "Frame id out of range.");
+  if (in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = 0;
+    size_--;
+  }
+}
+
+void CLOCKReplacer::Unpin(frame_id_t frame_id) {
+  ASSERT(static_cast<size_t>(frame_id) < capacity, "Frame id out of range.");
+  if (!in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = 1;
+    size_++;
+  }
+  ref_bit_[frame_id] = 1;
+}
+
+size_t CLOCKReplacer::PeekVictims(frame_id_t *frame_ids, size_t max_count) {
+  // frames whose reference bit is clear go first, the others follow once the hand has cleared their bits
+  size_t count = 0;
+  for (char referenced : {0, 1}) {
+    for (size_t i = 0; i < capacity && count < max_count; i++) {
+      size_t current = (hand_ + i) % capacity;
+      if (in_replacer_[current] && ref_bit_[current] == referenced) {
+        frame_ids[count++] = static_cast<frame_id_t>(current);
+      }
+    }
+  }
+  return count;
+}
+
+size_t CLOCKReplacer::Size() {
+  return size_;
+}
@@ -0,0 +1,39 @@
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <new>
+
+#include "glog/logging.h"
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) {
+  size_t size = num_frames * PAGE_SIZE;
+  ASSERT(size > 0, "Frame arena must have at least one frame.");
+  if (huge_pages && size >= HUGE_PAGE_SIZE) {
+    size_t huge_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *base = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+      base_ = static_cast<char *>(base);
+      mapped_size_ = huge_size;
+      huge_tlb_ = true;
+      return;
+    }
+  }
+  void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map a frame arena of " << size << " bytes" << std::endl;
+    throw std::bad_alloc();
+  }
+  base_ = static_cast<char *>(base);
+  mapped_size_ = size;
+#ifdef MADV_HUGEPAGE
+  // only a hint, the kernel may have transparent huge pages disabled
+  if (huge_pages && size >= HUGE_PAGE_SIZE) {
+    madvise(base_, mapped_size_, MADV_HUGEPAGE);
+  }
+#endif
+}
+
+FrameArena::~FrameArena() {
+  munmap(base_, mapped_size_);
+}
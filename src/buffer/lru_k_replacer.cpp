@@ -0,0 +1,82 @@
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : k_(std::max<size_t>(1, k)),
+      correlated_period_(correlated_period),
+      history_(num_pages * k_, 0),
+      ref_count_(num_pages, 0),
+      evictable_(num_pages, false) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  set<Candidate> &candidates = cold_.empty() ? hot_ : cold_;
+  if (candidates.empty()) {
+    return false;
+  }
+  *frame_id = candidates.begin()->second;
+  candidates.erase(candidates.begin());
+  // the frame will hold another page, so its history does not carry over
+  evictable_[*frame_id] = false;
+  ref_count_[*frame_id] = 0;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  ASSERT(static_cast<size_t>(frame_id) < ref_count_.size(), "Frame id out of range.");
+  if (evictable_[frame_id]) {
+    CandidateSet(frame_id).erase(MakeCandidate(frame_id));
+    evictable_[frame_id] = false;
+  }
+  // record the reference
+  uint64_t now = ++current_ts_;
+  size_t &count = ref_count_[frame_id];
+  if (count > 0 && now - History(frame_id, 0) <= correlated_period_) {
+    History(frame_id, 0) = now;
+    return;
+  }
+  count = std::min(count + 1, k_);
+  for (size_t i = count - 1; i > 0; i--) {
+    History(frame_id, i) = History(frame_id, i - 1);
+  }
+  History(frame_id, 0) = now;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  ASSERT(static_cast<size_t>(frame_id) < ref_count_.size(), "Frame id out of range.");
+  if (evictable_[frame_id]) {
+    return;
+  }
+  // a frame that was never pinned still needs a reference to be ordered by
+  if (ref_count_[frame_id] == 0) {
+    ref_count_[frame_id] = 1;
+    History(frame_id, 0) = ++current_ts_;
+  }
+  evictable_[frame_id] = true;
+  CandidateSet(frame_id).insert(MakeCandidate(frame_id));
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  ASSERT(static_cast<size_t>(frame_id) < ref_count_.size(), "Frame id out of range.");
+  if (evictable_[frame_id]) {
+    CandidateSet(frame_id).erase(MakeCandidate(frame_id));
+    evictable_[frame_id] = false;
+  }
+  ref_count_[frame_id] = 0;
+}
+
+size_t LRUKReplacer::PeekVictims(frame_id_t *frame_ids, size_t max_count) {
+  size_t count = 0;
+  for (const set<Candidate> *candidates : {&cold_, &hot_}) {
+    for (auto it = candidates->begin(); it != candidates->end() && count < max_count; ++it) {
+      frame_ids[count++] = it->second;
+    }
+  }
+  return count;
+}
+
+size_t LRUKReplacer::Size() {
+  return cold_.size() + hot_.size();
+}
@@ -40,6 +40,13 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
 	map[frame_id] = list_lru.begin();
 }
 
+size_t LRUReplacer::PeekVictims(frame_id_t *frame_ids, size_t max_count) {
+	size_t count = 0;
+	for(auto it = list_lru.rbegin(); it != list_lru.rend() && count < max_count; ++it)
+		frame_ids[count++] = *it;
+	return count;
+}
+
 /**
  * TODO: Student Implement
  */
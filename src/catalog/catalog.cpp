@@ -72,7 +72,7 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      c_heap_(new SimpleMemHeap()) {
+      c_heap_(new ArenaMemHeap()) {
   // ASSERT(false, "Not Implemented yet");
   if (init) {  // if the DataBase is created for the first time, init the metadata
     // catalog_meta_ = ALLOC_P(c_heap, CatalogMeta)();  //failed, CatelogMeta() is a private function
@@ -116,6 +116,10 @@ CatalogManager::~CatalogManager() {
    }
    **/
   FlushCatalogMetaPage();
+  // the arena frees the tables' memory but not what their heaps hold
+  for (auto &iter : tables_) {
+    iter.second->GetTableHeap()->~TableHeap();
+  }
   delete c_heap_;
 }
 
@@ -456,6 +460,8 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   }
 
   FlushCatalogMetaPage();
+  // give the table's pages back to the file system
+  buffer_pool_manager_->ReclaimSpace();
   return DB_SUCCESS;
 }
 
@@ -507,6 +513,8 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
   }
 
   FlushCatalogMetaPage();
+  // give the index's pages back to the file system
+  buffer_pool_manager_->ReclaimSpace();
   return DB_SUCCESS;
 }
 
@@ -3,7 +3,7 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size, bool direct_io)
     : db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
   db_file_name_ = "./databases/"+db_file_name_;
@@ -11,8 +11,8 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
     remove(db_file_name_.c_str());
   }
   // Initialize components
-  disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  disk_mgr_ = new DiskManager(db_file_name_, direct_io);
+  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, DEFAULT_BUFFER_POOL_SHARDS);
 
   // Allocate static page for db storage engine
   if (init) {
@@ -39,6 +39,7 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
     ASSERT(!bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Invalid header page.");
   }
   catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
+  bpm_->StartPageCleaner();
 }
 
 DBStorageEngine::~DBStorageEngine() {
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 
 #include <chrono>
+#include <fstream>
 
 #include "common/generate_name.h"
 #include "common/result_writer.h"
@@ -91,9 +92,11 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
     Row row{};
     while (executor->Next(&row, &rid)) {
       if (result_set != nullptr) {
-        result_set->push_back(row);
+        // the fields of the result rows are allocated from the arena of the query
+        result_set->emplace_back(row, exec_ctx->GetHeap());
       }
     }
+    VacuumAfterPlan(plan, exec_ctx);
   } catch (const exception &ex) {
     std::cout << "Error Encountered in Executor Execution: " << ex.what() << std::endl;
     if (result_set != nullptr) {
@@ -104,6 +107,29 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
   return DB_SUCCESS;
 }
 
+void ExecuteEngine::VacuumAfterPlan(const AbstractPlanNodeRef &plan, ExecuteContext *exec_ctx) {
+  std::string table_name;
+  if (plan->GetType() == PlanType::Delete) {
+    table_name = dynamic_cast<const DeletePlanNode *>(plan.get())->GetTableName();
+  } else if (plan->GetType() == PlanType::Update) {
+    table_name = dynamic_cast<const UpdatePlanNode *>(plan.get())->GetTableName();
+  } else {
+    return;
+  }
+  TableInfo *table_info = nullptr;
+  if (exec_ctx->GetCatalog()->GetTable(table_name, table_info) != DB_SUCCESS) {
+    return;
+  }
+  TableHeap *table_heap = table_info->GetTableHeap();
+  if (table_heap->NeedsVacuum()) {
+    [[maybe_unused]] VacuumStats stats = table_heap->Vacuum();
+#ifdef ENABLE_EXECUTE_DEBUG
+    LOG(INFO) << "Vacuumed " << table_name << ": " << stats.tuples_removed_ << " tuples, " << stats.bytes_reclaimed_
+              << " bytes, " << stats.pages_freed_ << " pages" << std::endl;
+#endif
+  }
+}
+
 dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   if (ast == nullptr) {
     return DB_FAILED;
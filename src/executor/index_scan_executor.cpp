@@ -70,14 +70,13 @@ bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   if (plan_->need_filter_) {
     // If need_filter is true, iterate through the set and check the predicate using a method similar to sequential scan
     while (begin != result.end()) {
-      Row resultRow(*begin);
-      table_info->GetTableHeap()->GetTuple(&resultRow, exec_ctx_->GetTransaction());
+      *row = Row(*begin);  // read in place, the memory of row's fields is reused
+      table_info->GetTableHeap()->GetTuple(row, exec_ctx_->GetTransaction());
       Field temp(kTypeInt, 1);
 
       // If need_filter
-      if (temp.CompareEquals(plan_->GetPredicate()->Evaluate(&resultRow))) {
+      if (temp.CompareEquals(plan_->GetPredicate()->Evaluate(row))) {
         // Compare if the condition is satisfied
-        *row = resultRow;
         *rid = *begin;
         begin++;
         return true;
@@ -88,9 +87,8 @@ bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   } else {
     // If need_filter is false, iterate through the set and retrieve the rows directly
     while (begin != result.end()) {
-      Row resultRow(*begin);
-      table_info->GetTableHeap()->GetTuple(&resultRow, exec_ctx_->GetTransaction());
-      *row = resultRow;
+      *row = Row(*begin);
+      table_info->GetTableHeap()->GetTuple(row, exec_ctx_->GetTransaction());
       *rid = *begin;
       begin++;
       return true;
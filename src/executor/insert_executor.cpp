@@ -4,17 +4,27 @@
 
 #include "executor/executors/insert_executor.h"
 #include "common/generate_name.h"
+#include "executor/plans/values_plan.h"
 
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
+InsertExecutor::~InsertExecutor() {
+  if (bulk_) {
+    table_heap_->EndAppend();
+  }
+}
+
 void InsertExecutor::Init() {
-  auto table_name_ = plan_->GetTableName();  // get table name
-  TableInfo *table_info_;                    // get table info
-  exec_ctx_->GetCatalog()->GetTable(table_name_, table_info_);
-  table_heap_ = table_info_->GetTableHeap();                // get table heap
-  iter_ = table_heap_->Begin(exec_ctx_->GetTransaction());  // get iterator
+  auto table_name_ = plan_->GetTableName();                         // get table name
+  exec_ctx_->GetCatalog()->GetTable(table_name_, table_info_);      // get table info
+  exec_ctx_->GetCatalog()->GetTableIndexes(table_name_, indexes_);  // get indexes of the table
+  table_heap_ = table_info_->GetTableHeap();                        // get table heap
+  // a load of many rows appends them, instead of searching free space for each
+  auto child_plan = plan_->GetChildPlan();
+  bulk_ = child_plan->GetType() == PlanType::Values &&
+          dynamic_cast<const ValuesPlanNode *>(child_plan.get())->GetValues().size() >= DEFAULT_BULK_INSERT_ROWS;
 	child_executor_->Init();
 }
 
@@ -23,8 +33,6 @@ bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
   RowId new_row_id;
   if (child_executor_->Next(&new_row, &new_row_id)) {
     auto table_name_ = plan_->GetTableName();  // get table name
-    TableInfo *table_info_;                    // get table info
-    exec_ctx_->GetCatalog()->GetTable(table_name_, table_info_);
 
     // check if the primary key has already existed
     if(table_info_->GetPrimaryKeys().size() != 0){
@@ -57,20 +65,23 @@ bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
 
     /** insert the row into the table **/
 	 	// if the row is empty
-    if (!table_info_->GetTableHeap()->InsertTuple(new_row, exec_ctx_->GetTransaction())) {
+    bool inserted = bulk_ ? table_heap_->AppendTuple(new_row, exec_ctx_->GetTransaction())
+                          : table_heap_->InsertTuple(new_row, exec_ctx_->GetTransaction());
+    if (!inserted) {
       return false;
     }
 
     new_row_id = new_row.GetRowId();
-    vector<IndexInfo *> index_infos_;  // get all index infos
-    exec_ctx_->GetCatalog()->GetTableIndexes(table_name_, index_infos_);
-    for (auto &index_info : index_infos_) {
+    for (auto &index_info : indexes_) {
       Row key_row;
       new_row.GetKeyFromRow(table_info_->GetSchema(), index_info->GetIndexKeySchema(), key_row);
       index_info->GetIndex()->InsertEntry(key_row, new_row.GetRowId(), exec_ctx_->GetTransaction());
     }
-
+    return true;
   } else {
+    if (bulk_) {
+      table_heap_->EndAppend();
+    }
     return false;
   }
 }
@@ -13,8 +13,9 @@ SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode
 }
 
 void SeqScanExecutor::Init() {
-  table_heap_ = table_info_->GetTableHeap();                // get table heap
-  iter_ = table_heap_->Begin(exec_ctx_->GetTransaction());  // get iterator
+  table_heap_ = table_info_->GetTableHeap();                                              // get table heap
+  strategy_ = std::make_unique<BufferAccessStrategy>(exec_ctx_->GetBufferPoolManager());  // private scan ring
+  iter_ = table_heap_->Begin(exec_ctx_->GetTransaction(), strategy_.get());               // get iterator
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
@@ -24,14 +25,15 @@ bool SeqScanExecutor::Next(Row *row, RowId *rid) {
       break;
     }
     if (plan_->GetPredicate() == nullptr) {  // No predicate
-      *row = Row(*iter_.GetRow());           // copy
+      *row = *iter_.GetRow();                // copy
       *rid = row->GetRowId();
       ++iter_;
       return true;
     }
 
-    if (temp.CompareEquals(plan_->GetPredicate()->Evaluate(iter_.GetRow()))) {  // if predicate is true
-      *row = Row(*iter_.GetRow());                                              // copy
+    // test the tuple in place, only a row that matches is built
+    if (temp.CompareEquals(plan_->GetPredicate()->Evaluate(iter_.GetRowView()))) {  // if predicate is true
+      *row = *iter_.GetRow();                                                       // copy
       *rid = row->GetRowId();
       ++iter_;
       return true;
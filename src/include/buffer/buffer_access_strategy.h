@@ -0,0 +1,47 @@
+#ifndef MINISQL_BUFFER_ACCESS_STRATEGY_H
+#define MINISQL_BUFFER_ACCESS_STRATEGY_H
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy gives a bulk reader, e.g. a sequential scan, a small private ring of frames.
+ *
+ * Pages that the reader misses on are loaded into frames of the ring instead of frames taken from the shared
+ * replacer, and once the ring is full its frames are recycled in order. Ring frames never enter the replacer while
+ * the strategy is alive, so a large scan can not push the working set of other sessions out of the pool. Pages that
+ * are already cached are used in place. When the strategy is destroyed its frames are handed back to the pool.
+ *
+ * A strategy must only be used by one thread at a time and must not outlive its buffer pool.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * @param bpm the buffer pool the strategy reads through
+   * @param ring_size total number of frames in the ring, spread over the shards of the pool
+   */
+  explicit BufferAccessStrategy(BufferPoolManager *bpm, size_t ring_size = DEFAULT_SCAN_RING_SIZE);
+
+  ~BufferAccessStrategy();
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+ private:
+  /** The ring of one shard of the pool; frame ids are local to the shard. */
+  struct Ring {
+    std::vector<frame_id_t> frames_;
+    size_t capacity_{0};
+    size_t cursor_{0};  // next ring slot to recycle
+  };
+
+  BufferPoolManager *bpm_;
+  std::vector<Ring> rings_;  // one ring per shard
+};
+
+#endif  // MINISQL_BUFFER_ACCESS_STRATEGY_H
@@ -1,58 +1,294 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <list>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
+#include "storage/async_io.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/**
+ * BufferPoolManager caches disk pages in a fixed number of frames.
+ *
+ * The frames are split into num_shards equally sized shards. A page always lives in the shard selected by
+ * page_id % num_shards, and each shard has its own page table, free list, replacer and latch, so threads that
+ * touch pages of different shards never contend with each other. Every shard uses the replacement policy given by
+ * replacer_type.
+ *
+ * An optional background page cleaner writes dirty pages back shortly before the replacers would evict them, so
+ * that a miss usually finds a clean victim and only pays for reading the page it asked for. Sequential readers can
+ * have the pages ahead of them read in the background as well, see ReadAhead.
+ */
 class BufferPoolManager {
+  friend class BufferAccessStrategy;
+
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /** Extracts the id of the page that follows a page in a chain of pages, INVALID_PAGE_ID at the end of the chain. */
+  using NextPageIdFunc = page_id_t (*)(Page *page);
+
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_shards = 1,
+                             ReplacerType replacer_type = ReplacerType::LRU);
 
   ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  /**
+   * Fetch a page and pin it.
+   * @param strategy if not null, a miss loads the page into a frame of the strategy's ring instead of a shared frame
+   */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
   bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Write back every page in the pool, keeping up to DEFAULT_IO_QUEUE_DEPTH writes in flight, and then the disk
+   * manager's allocation metadata. Each shard is latched while its pages are written.
+   */
+  void FlushAllPages();
+
+  /**
+   * Allocate a new page and pin it.
+   * @param run if not null, the page is taken from this allocation run of the caller, see DiskManager
+   */
+  Page *NewPage(page_id_t &page_id, AllocationRun *run = nullptr);
+
+  /** Hand the pages of an allocation run that were not used back to the disk manager. */
+  void ReleaseAllocationRun(AllocationRun *run);
 
   bool DeletePage(page_id_t page_id);
 
+  /** Give the disk space of the free pages back to the file system, see DiskManager::ReclaimSpace. */
+  void ReclaimSpace();
+
   bool IsPageFree(page_id_t page_id);
 
   bool CheckAllUnpinned();
 
+  /** @return the total number of frames in the buffer pool */
+  size_t GetPoolSize() const { return pool_size_; }
+
+  /** @return the number of shards the frames are partitioned into */
+  size_t GetShardCount() const { return shards_.size(); }
+
+  /** @return the number of FetchPage calls that found the page in the pool */
+  uint64_t GetHitCount();
+
+  /** @return the number of FetchPage calls that had to read the page from disk */
+  uint64_t GetMissCount();
+
+  /**
+   * Start the background page cleaner. Once per interval, or as soon as a shard crosses high_dirty_ratio, the
+   * cleaner walks the eviction candidates of every shard in which more than low_dirty_ratio of the frames are
+   * dirty and writes them back, next victim first, until the shard is back at low_dirty_ratio.
+   * Does nothing if the cleaner is already running.
+   * @param low_dirty_ratio fraction of dirty frames a shard may keep without being cleaned
+   * @param high_dirty_ratio fraction of dirty frames at which UnpinPage wakes the cleaner early
+   * @param interval_ms time the cleaner sleeps between two rounds
+   */
+  void StartPageCleaner(double low_dirty_ratio = DEFAULT_CLEANER_LOW_DIRTY_RATIO,
+                        double high_dirty_ratio = DEFAULT_CLEANER_HIGH_DIRTY_RATIO,
+                        uint32_t interval_ms = DEFAULT_CLEANER_INTERVAL_MS);
+
+  /** Stop the background page cleaner and wait for it to finish its current round. */
+  void StopPageCleaner();
+
+  /** @return the number of dirty pages written back by the page cleaner */
+  uint64_t GetCleanerWriteCount();
+
+  /** @return the number of dirty victims written back synchronously by FetchPage or NewPage */
+  uint64_t GetForegroundWriteCount();
+
+  /**
+   * Asynchronously load up to count pages of a chain of pages into the pool, starting at page_id, so that a reader
+   * walking the chain finds them cached. A background thread follows the chain with next_page_id, skipping pages that
+   * are already cached, and stops early when the shard of the next page has no frame to spare. A FetchPage of a page
+   * that is still being read waits for that read instead of issuing another one.
+   * @param strategy if not null, the pages are loaded into the strategy's ring. Pending reads for a strategy are
+   *        cancelled when the strategy is destroyed.
+   */
+  void ReadAhead(page_id_t page_id, size_t count, NextPageIdFunc next_page_id,
+                 BufferAccessStrategy *strategy = nullptr);
+
+  /** @return the number of pages loaded by ReadAhead */
+  uint64_t GetReadAheadCount();
+
+  /** @return the number of dirty victims written back by ReadAhead to make room for the pages it loads */
+  uint64_t GetReadAheadWriteCount();
+
  private:
+  /**
+   * A shard owns num_frames_ consecutive frames of pages_, starting at frames_. Frame ids stored in the page table,
+   * the free list and the replacer are local to the shard, i.e. in [0, num_frames_).
+   */
+  struct Shard {
+    Page *frames_;                                     // first frame owned by this shard
+    size_t num_frames_;                                // number of frames owned by this shard
+    unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+    Replacer *replacer_;                               // to find an unpinned page for replacement
+    list<frame_id_t> free_list_;                       // to find a free page for replacement
+    vector<BufferAccessStrategy *> owners_;            // strategy whose ring a frame belongs to, if any
+    uint64_t hits_{0};                                 // FetchPage calls served from the pool
+    uint64_t misses_{0};                               // FetchPage calls that read from disk
+    size_t dirty_frames_{0};                           // frames whose page is dirty
+    uint64_t cleaner_writes_{0};                       // dirty pages written back by the page cleaner
+    uint64_t foreground_writes_{0};                    // dirty victims written back on a miss
+    uint64_t read_ahead_pages_{0};                     // pages loaded by read-ahead
+    uint64_t read_ahead_writes_{0};                    // dirty victims written back to make room for read-ahead
+    vector<char> reading_;                             // whether a frame's page is being read ahead
+    std::condition_variable read_done_;                // signalled whenever a read-ahead of the shard completes
+    mutex latch_;                                      // to protect the fields above and the frames' metadata
+  };
+
+  /** @return a new replacer of the configured policy for num_frames frames */
+  Replacer *CreateReplacer(size_t num_frames);
+
+  /** @return the index of the shard that page_id is mapped to */
+  size_t GetShardIndex(page_id_t page_id) const { return static_cast<uint32_t>(page_id) % shards_.size(); }
+
+  /** @return the shard that page_id is mapped to */
+  Shard &GetShard(page_id_t page_id) { return *shards_[GetShardIndex(page_id)]; }
+
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(AllocationRun *run);
 
   /**
    * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
    */
   void DeallocatePage(page_id_t page_id);
 
-  frame_id_t TryToFindFreePage();
+  /**
+   * Pin a zeroed frame of its shard for a newly allocated page.
+   * @return the page, or nullptr if every frame of the shard is pinned
+   */
+  Page *NewPageInShard(page_id_t page_id);
+
+  /**
+   * Pick a frame from the free list or, failing that, evict a victim chosen by the replacer. A dirty victim is
+   * written back and dropped from the page table. The caller must hold shard.latch_.
+   * @param read_ahead whether the frame is for the read-ahead thread rather than a miss, see EvictFrame
+   * @return the local frame id, or INVALID_FRAME_ID if every frame of the shard is pinned
+   */
+  frame_id_t TryToFindFreePage(Shard &shard, bool read_ahead = false);
+
+  /**
+   * Write back the page held by an unpinned frame if it is dirty and drop it from the page table.
+   * The caller must hold shard.latch_.
+   * @param read_ahead whether the write is counted as a read-ahead write instead of a foreground write
+   */
+  void EvictFrame(Shard &shard, frame_id_t frame_id, bool read_ahead = false);
+
+  /**
+   * Pick a frame for a page missed by a reader with an access strategy. The ring grows with frames of the shared
+   * pool until it is full and is then recycled; a ring frame that someone else still pins is skipped. Falls back to
+   * TryToFindFreePage when no ring frame can be used. The caller must hold shard.latch_.
+   */
+  frame_id_t TryToFindRingPage(Shard &shard, size_t shard_index, BufferAccessStrategy *strategy,
+                               bool read_ahead = false);
+
+  /**
+   * Hand the ring frames of a strategy that is going away back to the replacers.
+   */
+  void ReleaseStrategy(BufferAccessStrategy *strategy);
+
+  /** Main loop of the page cleaner thread. */
+  void RunPageCleaner();
+
+  /**
+   * Write back dirty eviction candidates of a shard until at most the low dirty ratio of its frames is dirty.
+   * The shard latch is taken per batch of up to CLEANER_BATCH_PAGES writes that are in flight together, so
+   * foreground threads are only held up by one batch at a time.
+   */
+  void CleanShard(Shard &shard, AsyncIO *io);
+
+  /**
+   * Write back a batch of frames of a shard at once and mark the ones that were written clean.
+   * The caller must hold shard.latch_, and none of the frames may still be being read in. A frame may be pinned: a
+   * writer that changes it while it is written marks it dirty again when it unpins it, so the change is written later.
+   * @return the number of frames written back
+   */
+  size_t WriteFrames(Shard &shard, AsyncIO *io, const frame_id_t *frame_ids, size_t count);
+
+  /** Wake the page cleaner up before its interval has passed. */
+  void WakePageCleaner();
+
+  /**
+   * Look a page up in the page table of its shard, waiting for a read-ahead of the page to complete first.
+   * @param lock the caller's lock on shard.latch_
+   */
+  unordered_map<page_id_t, frame_id_t>::iterator FindPage(Shard &shard, std::unique_lock<mutex> &lock,
+                                                          page_id_t page_id);
+
+  /**
+   * Forget the page held by an unpinned frame without writing it back and return the frame to the free list.
+   * The caller must hold shard.latch_.
+   */
+  void DropFrame(Shard &shard, frame_id_t frame_id);
+
+  /** Main loop of the read-ahead thread. */
+  void RunReadAhead();
+
+  /**
+   * Load one page for a read-ahead request unless it is cached already.
+   * @return the id of the next page of the chain, INVALID_PAGE_ID if the request should stop here
+   */
+  page_id_t ReadAheadPage(page_id_t page_id, NextPageIdFunc next_page_id, BufferAccessStrategy *strategy);
+
+  /** Drop the queued read-ahead requests of a strategy and wait for the one in progress, if any, to stop. */
+  void CancelReadAhead(BufferAccessStrategy *strategy);
 
  private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
-  DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
-  list<frame_id_t> free_list_;                       // to find a free page for replacement
-  recursive_mutex latch_;                            // to protect shared data structure
+  static constexpr size_t MAX_NEW_PAGE_ROUNDS = 4;  // NewPage tries up to this many page ids per shard
+
+  size_t pool_size_;            // number of pages in buffer pool
+  FrameArena *arena_;           // data of all frames, frame i at arena_->GetFrame(i)
+  Page *pages_;                 // dense array of frame descriptors, pages_[i] describes frame i
+  DiskManager *disk_manager_;   // pointer to the disk manager.
+  ReplacerType replacer_type_;  // replacement policy of every shard
+  vector<Shard *> shards_;      // partitions of the pool, indexed by page_id % shards_.size()
+
+  std::thread cleaner_;                    // background page cleaner, if started
+  std::atomic<bool> cleaner_running_{false};
+  bool cleaner_stop_{false};               // asks the cleaner to exit, protected by cleaner_latch_
+  bool cleaner_woken_{false};              // asks the cleaner for an early round, protected by cleaner_latch_
+  double cleaner_low_dirty_ratio_{DEFAULT_CLEANER_LOW_DIRTY_RATIO};
+  double cleaner_high_dirty_ratio_{DEFAULT_CLEANER_HIGH_DIRTY_RATIO};
+  std::chrono::milliseconds cleaner_interval_{DEFAULT_CLEANER_INTERVAL_MS};
+  mutex cleaner_latch_;
+  std::condition_variable cleaner_cv_;
+
+  struct ReadAheadRequest {
+    page_id_t page_id_;
+    size_t count_;
+    NextPageIdFunc next_page_id_;
+    BufferAccessStrategy *strategy_;
+  };
+  std::thread read_ahead_;                         // background reader, started by the first ReadAhead
+  std::deque<ReadAheadRequest> read_ahead_queue_;  // protected by read_ahead_latch_
+  bool read_ahead_busy_{false};                    // a request is in progress, protected by read_ahead_latch_
+  BufferAccessStrategy *read_ahead_strategy_{nullptr};  // strategy of the request in progress
+  std::atomic<bool> read_ahead_stop_{false};
+  std::atomic<bool> read_ahead_cancel_{false};  // asks the request in progress to stop
+  mutex read_ahead_latch_;
+  std::condition_variable read_ahead_cv_;
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -1,21 +1,20 @@
 #ifndef MINISQL_CLOCK_REPLACER_H
 #define MINISQL_CLOCK_REPLACER_H
 
-#include <algorithm>
-#include <list>
-#include <map>
-#include <mutex>
-#include <queue>
-#include <unordered_set>
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 using namespace std;
 
 /**
  * CLOCKReplacer implements the clock replacement.
+ *
+ * Every frame owns a slot in two flat arrays: whether it is currently in the replacer and its reference bit. Unpin
+ * sets the reference bit, and Victim sweeps the clock hand over the slots, giving every referenced frame a second
+ * chance by clearing its bit. Pin and Unpin are O(1) and never allocate.
  */
 class CLOCKReplacer : public Replacer {
  public:
@@ -36,12 +35,16 @@ class CLOCKReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  size_t PeekVictims(frame_id_t *frame_ids, size_t max_count) override;
+
   size_t Size() override;
 
  private:
   size_t capacity;
-  list<frame_id_t> clock_list;               // replacer中可以被替换的数据页
-  map<frame_id_t, frame_id_t> clock_status;  // 数据页的存储状态
+  vector<char> in_replacer_;  // whether the frame can be victimized
+  vector<char> ref_bit_;      // whether the frame was referenced since the hand last passed it
+  size_t hand_{0};            // next frame the clock hand looks at
+  size_t size_{0};            // number of frames in the replacer
 };
 
 #endif  // MINISQL_CLOCK_REPLACER_H
\ No newline at end of file
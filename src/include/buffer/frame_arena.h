@@ -0,0 +1,42 @@
+#ifndef MINISQL_FRAME_ARENA_H
+#define MINISQL_FRAME_ARENA_H
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * FrameArena is the memory that holds the data of all frames of a buffer pool: one contiguous block in which frame i
+ * starts at byte i * PAGE_SIZE, so every frame is PAGE_SIZE aligned.
+ *
+ * With huge_pages set, an arena of at least one huge page is first mapped with MAP_HUGETLB. When no huge pages are
+ * reserved on the system the arena falls back to regular pages and asks for transparent huge pages instead.
+ */
+class FrameArena {
+ public:
+  /**
+   * @param num_frames number of PAGE_SIZE frames in the arena
+   * @param huge_pages whether the arena should be backed by huge pages if possible
+   */
+  explicit FrameArena(size_t num_frames, bool huge_pages = true);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of a frame, zeroed when the arena is created */
+  inline char *GetFrame(size_t frame_id) { return base_ + frame_id * PAGE_SIZE; }
+
+  /** @return whether the arena is mapped with MAP_HUGETLB */
+  inline bool IsHugeTLB() const { return huge_tlb_; }
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+ private:
+  char *base_{nullptr};
+  size_t mapped_size_{0};  // size of the mapping, a multiple of HUGE_PAGE_SIZE for MAP_HUGETLB
+  bool huge_tlb_{false};
+};
+
+#endif  // MINISQL_FRAME_ARENA_H
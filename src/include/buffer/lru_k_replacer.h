@@ -0,0 +1,75 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The replacer remembers the timestamps of the last K references to every frame, where a reference is a Pin. The
+ * victim is the evictable frame whose K-th most recent reference lies furthest in the past (the largest backward
+ * K-distance). Frames with fewer than K references have an infinite backward K-distance and are evicted first,
+ * oldest reference first. A page that is only touched once, e.g. by a table scan, therefore never displaces a page
+ * that is referenced over and over, e.g. a B+ tree internal page.
+ *
+ * References that follow each other within correlated_period ticks of the replacer's clock are treated as a single
+ * correlated reference, so that fetching the same page several times in a row does not make it look hot.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references remembered per frame
+   * @param correlated_period references closer than this many ticks count as one
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2, uint64_t correlated_period = 1);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t PeekVictims(frame_id_t *frame_ids, size_t max_count) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  using Candidate = pair<uint64_t, frame_id_t>;  // (eviction key, frame id), smallest key is evicted first
+
+  /** @return the timestamp of the i-th most recent reference of a frame, i starting at 0 */
+  uint64_t &History(frame_id_t frame_id, size_t i) { return history_[frame_id * k_ + i]; }
+
+  /** @return the candidate entry of an evictable frame */
+  Candidate MakeCandidate(frame_id_t frame_id) { return {History(frame_id, ref_count_[frame_id] - 1), frame_id}; }
+
+  /** @return the set an evictable frame is kept in */
+  set<Candidate> &CandidateSet(frame_id_t frame_id) { return ref_count_[frame_id] < k_ ? cold_ : hot_; }
+
+  size_t k_;
+  uint64_t correlated_period_;
+  uint64_t current_ts_{0};
+  vector<uint64_t> history_;  // k_ timestamps per frame, most recent first
+  vector<size_t> ref_count_;  // number of valid timestamps per frame
+  vector<bool> evictable_;
+  set<Candidate> cold_;  // evictable frames with less than k_ references, keyed by their oldest reference
+  set<Candidate> hot_;   // evictable frames with k_ references, keyed by their k-th most recent reference
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -5,6 +5,9 @@
 
 #include "common/config.h"
 
+/** Replacement policies the buffer pool can be configured with. */
+enum class ReplacerType { LRU = 0, LRUK, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -33,6 +36,21 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forgets a frame entirely, e.g. because its page was deleted and the frame returns to the free list.
+   * Policies that keep access history beyond the evictable set should drop it here.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Reports, without removing them, the frames that Victim would pick next, in eviction order.
+   * @param[out] frame_ids receives at most max_count frame ids
+   * @param max_count the maximum number of frames to report
+   * @return the number of frame ids written to frame_ids
+   */
+  virtual size_t PeekVictims(frame_id_t *frame_ids, size_t max_count) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -99,8 +99,10 @@ class CatalogManager {
 
   dberr_t GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes) const;
 
+  /** Drop a table and its indexes, and give the disk space of their pages back, see BufferPoolManager::ReclaimSpace */
   dberr_t DropTable(const std::string &table_name);
 
+  /** Drop an index and give the disk space of its pages back */
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
  private:
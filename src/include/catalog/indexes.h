@@ -92,7 +92,7 @@ class IndexInfo {
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
  private:
-  explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr}, i_heap_(new SimpleMemHeap()) {}
+  explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr}, i_heap_(new ArenaMemHeap()) {}
 
   Index *CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type = "bptree");
 
@@ -90,7 +90,7 @@ class TableInfo {
   inline vector<string> GetUniqueKeys() const { return table_meta_->GetUniqueKeys(); }
 
  private:
-  explicit TableInfo() : t_heap_(new SimpleMemHeap()){};
+  explicit TableInfo() : t_heap_(new ArenaMemHeap()){};
 
  private:
   TableMetadata *table_meta_;
@@ -13,8 +13,23 @@ static constexpr int META_PAGE_ID = 0;          // physical page id of the disk
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
+// size of a data page in byte, chosen with the MINISQL_PAGE_SIZE build option
+#ifndef MINISQL_PAGE_SIZE
+#define MINISQL_PAGE_SIZE 4096
+#endif
+static constexpr int PAGE_SIZE = MINISQL_PAGE_SIZE;
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384 || PAGE_SIZE == 32768,
+              "Unsupported page size.");
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_SHARDS = 8;    // default number of latch partitions of the buffer pool
+static constexpr int DEFAULT_SCAN_RING_SIZE = 32;       // default number of frames a sequential scan cycles through
+static constexpr double DEFAULT_CLEANER_LOW_DIRTY_RATIO = 0.1;   // page cleaner leaves shards this clean alone
+static constexpr double DEFAULT_CLEANER_HIGH_DIRTY_RATIO = 0.5;  // dirtier shards wake the page cleaner at once
+static constexpr int DEFAULT_CLEANER_INTERVAL_MS = 50;           // page cleaner sleep between rounds
+static constexpr int DEFAULT_READ_AHEAD_PAGES = 16;  // pages a sequential reader keeps on their way into the pool
+static constexpr int DEFAULT_IO_QUEUE_DEPTH = 32;    // asynchronous page I/Os kept in flight at once
+static constexpr int DEFAULT_ALLOCATION_RUN_PAGES = 64;  // contiguous pages reserved per table heap or index
+static constexpr int DEFAULT_BULK_INSERT_ROWS = 64;      // rows from which an INSERT appends to the table's end
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
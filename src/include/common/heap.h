@@ -1,6 +1,7 @@
 #ifndef MINISQL_MEM_HEAP_H
 #define MINISQL_MEM_HEAP_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <unordered_set>
@@ -54,4 +55,110 @@ private:
   std::unordered_set<void *> allocated_;
 };
 
+/**
+ * ArenaMemHeap hands out memory by bumping a pointer through chunks it mallocs, the first of first_chunk_size bytes
+ * and each next one twice as large up to MAX_CHUNK_SIZE; an allocation larger than the next chunk gets a chunk of its
+ * own. Free does nothing: all the memory is given back at once by Reset or the destructor, which suits objects that
+ * die together, like the fields of a row or the result rows of a query. Reset keeps the current chunk, so a heap
+ * that is reset after every row allocates nothing once it has grown to fit a row.
+ */
+class ArenaMemHeap : public MemHeap {
+ public:
+  static constexpr size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+  explicit ArenaMemHeap(size_t first_chunk_size = 4096) : next_chunk_size_(first_chunk_size) {}
+
+  ArenaMemHeap(const ArenaMemHeap &) = delete;
+
+  ArenaMemHeap &operator=(const ArenaMemHeap &) = delete;
+
+  /** The chunks move with the heap, memory allocated from other stays where it is. */
+  ArenaMemHeap(ArenaMemHeap &&other) noexcept
+      : head_(other.head_), cur_(other.cur_), end_(other.end_), next_chunk_size_(other.next_chunk_size_) {
+    other.head_ = nullptr;
+    other.cur_ = other.end_ = nullptr;
+  }
+
+  ArenaMemHeap &operator=(ArenaMemHeap &&other) noexcept {
+    if (this != &other) {
+      FreeChunks(head_);
+      head_ = other.head_;
+      cur_ = other.cur_;
+      end_ = other.end_;
+      next_chunk_size_ = other.next_chunk_size_;
+      other.head_ = nullptr;
+      other.cur_ = other.end_ = nullptr;
+    }
+    return *this;
+  }
+
+  ~ArenaMemHeap() override { FreeChunks(head_); }
+
+  void *Allocate(size_t size) override {
+    // round up so that every allocation is aligned for any type, a zero-size one still gets a distinct address
+    size = ((size == 0 ? 1 : size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (size > static_cast<size_t>(end_ - cur_)) {
+      return AllocateChunk(size);
+    }
+    void *buf = cur_;
+    cur_ += size;
+    return buf;
+  }
+
+  void Free(void *) override {}
+
+  /** Give back everything allocated so far, the current chunk is kept for the allocations that follow. */
+  void Reset() {
+    if (head_ == nullptr) {
+      return;
+    }
+    FreeChunks(head_->next_);
+    head_->next_ = nullptr;
+    cur_ = head_->Data();
+  }
+
+ private:
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  struct alignas(ALIGNMENT) Chunk {
+    Chunk *next_;
+    size_t size_;
+
+    char *Data() { return reinterpret_cast<char *>(this + 1); }
+  };
+
+  void *AllocateChunk(size_t size) {
+    bool own_chunk = head_ != nullptr && size > next_chunk_size_;
+    size_t chunk_size = own_chunk || size > next_chunk_size_ ? size : next_chunk_size_;
+    auto *chunk = static_cast<Chunk *>(malloc(sizeof(Chunk) + chunk_size));
+    ASSERT(chunk != nullptr, "Out of memory exception");
+    chunk->size_ = chunk_size;
+    if (own_chunk) {
+      // linked behind the current chunk, whose free space is still used
+      chunk->next_ = head_->next_;
+      head_->next_ = chunk;
+      return chunk->Data();
+    }
+    chunk->next_ = head_;
+    head_ = chunk;
+    next_chunk_size_ = next_chunk_size_ * 2 < MAX_CHUNK_SIZE ? next_chunk_size_ * 2 : MAX_CHUNK_SIZE;
+    cur_ = chunk->Data() + size;
+    end_ = chunk->Data() + chunk_size;
+    return chunk->Data();
+  }
+
+  static void FreeChunks(Chunk *chunk) {
+    while (chunk != nullptr) {
+      Chunk *next = chunk->next_;
+      free(chunk);
+      chunk = next;
+    }
+  }
+
+  Chunk *head_{nullptr};  // the current chunk, followed by the older ones
+  char *cur_{nullptr};
+  char *end_{nullptr};
+  size_t next_chunk_size_;
+};
+
 #endif //MINISQL_MEM_HEAP_H
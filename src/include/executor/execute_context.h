@@ -7,6 +7,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/heap.h"
 #include "common/macros.h"
 #include "transaction/transaction.h"
 
@@ -34,6 +35,9 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the arena of the query, e.g. for its result rows, released with the context */
+  MemHeap *GetHeap() { return &heap_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -41,6 +45,8 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** The arena that memory living as long as the query is allocated from */
+  ArenaMemHeap heap_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
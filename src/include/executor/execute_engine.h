@@ -43,6 +43,12 @@ class ExecuteEngine {
  private:
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecuteContext *exec_ctx, const AbstractPlanNodeRef &plan);
 
+  /**
+   * Without transactions every statement commits when it ends, so the rows a DELETE or UPDATE marked deleted can be
+   * removed from its table then. Vacuum the table once TableHeap::NeedsVacuum says that pays off.
+   */
+  static void VacuumAfterPlan(const AbstractPlanNodeRef &plan, ExecuteContext *exec_ctx);
+
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *context);
@@ -12,7 +12,8 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. A statement that inserts at least DEFAULT_BULK_INSERT_ROWS
+ * rows appends them to the end of the table with TableHeap::AppendTuple, fewer rows go to wherever there is room.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -25,6 +26,9 @@ class InsertExecutor : public AbstractExecutor {
   InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                  std::unique_ptr<AbstractExecutor> &&child_executor);
 
+  /** Finish an append the insert left in progress, e.g. when a duplicate key stopped it */
+  ~InsertExecutor() override;
+
   /** Initialize the insert */
   void Init() override;
 
@@ -46,8 +50,9 @@ class InsertExecutor : public AbstractExecutor {
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableHeap *table_heap_;
-  TableIterator iter_;
-  
+  TableInfo *table_info_{nullptr};
+  std::vector<IndexInfo *> indexes_;
+  bool bulk_{false};  // whether rows are appended to the end of the table
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
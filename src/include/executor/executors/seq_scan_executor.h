@@ -5,8 +5,10 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/seq_scan_plan.h"
@@ -44,6 +46,8 @@ class SeqScanExecutor : public AbstractExecutor {
   TableInfo *table_info_;
   /** The table heap to scan */
   TableHeap *table_heap_;
+  /** The ring of frames the scan reads through, so that it does not flush the buffer pool */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
   /** The iterator over the table heap */
   TableIterator iter_;
   
@@ -1,6 +1,7 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
@@ -26,6 +27,7 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage;
 
  public:
+  // The max sizes of the nodes default to as many key pairs as fit into a PAGE_SIZE page.
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 	template<typename N> void UpdateParentKey(N* node); 
@@ -62,7 +64,7 @@ class BPlusTree {
     }
     out << "digraph G {" << std::endl;
     Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-    auto *node = reinterpret_cast<BPlusTreePage *>(root_page);
+    auto *node = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
     ToGraph(node, buffer_pool_manager_, out);
     out << "}" << std::endl;
   }
@@ -111,6 +113,7 @@ class BPlusTree {
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  AllocationRun run_;  // contiguous pages reserved for the tree's next pages
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -5,6 +5,7 @@
 
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 
 class GenericKey {
   friend class KeyManager;
@@ -31,25 +32,16 @@ class KeyManager {
     ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
   }
 
-  // compare
+  // compare, reading both keys in place
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
     uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
+    RowView lhs_key(lhs->data, key_schema_);
+    RowView rhs_key(rhs->data, key_schema_);
 
     for (uint32_t i = 0; i < column_count; i++) {
-      Field *rhs_value = rhs_key.GetField(i);
-      Field *lhs_value = lhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
+      int cmp = lhs_key.CompareColumn(i, rhs_key);
+      if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
       }
     }
     // equals
@@ -20,6 +20,13 @@ class BitmapPage {
    */
   bool AllocatePage(uint32_t &page_offset);
 
+  /**
+   * Allocate run_size contiguous pages that start at a multiple of run_size, which must be a multiple of 8.
+   * @param page_offset Index in extent of the first page of the run.
+   * @return true if a free run was found.
+   */
+  bool AllocateRun(uint32_t run_size, uint32_t &page_offset);
+
   /**
    * @return true if successfully de-allocate a page.
    */
@@ -43,6 +50,11 @@ class BitmapPage {
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
+  /**
+   * @return the lowest free page, there must be one
+   */
+  uint32_t FindFreePage() const;
+
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
 
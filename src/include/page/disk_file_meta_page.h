@@ -2,27 +2,67 @@
 #define MINISQL_DISK_FILE_META_PAGE_H
 
 #include <cstdint>
+#include <limits>
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+// logical page ids stay below this bound, so that every page of an extent has a valid page id
+static constexpr page_id_t MAX_VALID_PAGE_ID = std::numeric_limits<page_id_t>::max() /
+                                               BitmapPage<PAGE_SIZE>::GetMaxSupportedSize() *
+                                               BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
+/**
+ * The first page of the db file: the page counts and the number of used pages of each extent.
+ *
+ * The counts of the extents that do not fit into this page continue in a chain of DiskFileMetaOverflowPage, the
+ * first of which is next_page_id_. Files written before version 2 had no header besides the two counts, and at most
+ * V1_MAX_EXTENTS used page counts right after them; the disk manager upgrades them when it opens them. Those files
+ * always have V1_PAGE_SIZE byte pages.
+ */
 class DiskFileMetaPage {
  public:
+  static constexpr uint32_t MAGIC = 0x4154454d;  // "META", more than a version 1 file can count for extent 0
+  static constexpr uint32_t VERSION = 2;
+  static constexpr uint32_t V1_PAGE_SIZE = 4096;
+  static constexpr uint32_t V1_MAX_EXTENTS = (V1_PAGE_SIZE - 2 * sizeof(uint32_t)) / sizeof(uint32_t);
+  static constexpr uint32_t MAX_EXTENTS = (PAGE_SIZE - 6 * sizeof(uint32_t) - sizeof(page_id_t)) / sizeof(uint32_t);
+
   uint32_t GetExtentNums() { return num_extents_; }
 
   uint32_t GetAllocatedPages() { return num_allocated_pages_; }
 
+  /** @return the used page count of an extent, 0 for the extents whose count is kept in an overflow page */
   uint32_t GetExtentUsedPage(uint32_t extent_id) {
-    if (extent_id >= num_extents_) {
+    if (extent_id >= num_extents_ || extent_id >= MAX_EXTENTS) {
       return 0;
     }
     return extent_used_page_[extent_id];
   }
 
+  /** @return whether the page has the version 2 header */
+  bool HasHeader() const { return magic_ == MAGIC; }
+
  public:
   uint32_t num_allocated_pages_{0};
   uint32_t num_extents_{0};  // each extent consists with a bit map and BIT_MAP_SIZE pages
+  uint32_t magic_{0};
+  uint32_t version_{0};
+  uint32_t page_id_size_{0};                 // sizeof(page_id_t) of the build that wrote the file
+  uint32_t page_size_{0};                    // PAGE_SIZE of the build that wrote the file
+  page_id_t next_page_id_{INVALID_PAGE_ID};  // logical page id of the first overflow page
+  uint32_t extent_used_page_[0];
+};
+
+/**
+ * A page of the chain that continues the used page counts of DiskFileMetaPage. Overflow pages are allocated like
+ * any other logical page.
+ */
+class DiskFileMetaOverflowPage {
+ public:
+  static constexpr uint32_t MAX_EXTENTS = (PAGE_SIZE - sizeof(page_id_t)) / sizeof(uint32_t);
+
+ public:
+  page_id_t next_page_id_{INVALID_PAGE_ID};
   uint32_t extent_used_page_[0];
 };
 
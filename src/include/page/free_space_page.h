@@ -0,0 +1,33 @@
+#ifndef MINISQL_FREE_SPACE_PAGE_H
+#define MINISQL_FREE_SPACE_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * A page of a table heap's free space map: the free bytes of up to CAPACITY table pages, in the order the pages were
+ * added to the heap. The pages of a map form a chain through next_page_id_. An entry whose page id is
+ * INVALID_PAGE_ID belongs to a page that was removed from the heap.
+ */
+class FreeSpacePage {
+ public:
+  static constexpr uint32_t CAPACITY =
+      (PAGE_SIZE - sizeof(page_id_t) - sizeof(uint32_t)) / (sizeof(page_id_t) + sizeof(uint16_t));
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+ public:
+  page_id_t next_page_id_;
+  uint32_t count_;  // number of entries used
+  page_id_t page_ids_[CAPACITY];
+  uint16_t free_spaces_[CAPACITY];
+};
+
+static_assert(sizeof(FreeSpacePage) <= PAGE_SIZE, "FreeSpacePage does not fit into a page.");
+static_assert(PAGE_SIZE <= UINT16_MAX + 1, "Free space of a page does not fit into 16 bits.");
+
+#endif  // MINISQL_FREE_SPACE_PAGE_H
@@ -1,6 +1,7 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
@@ -12,6 +13,9 @@
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The page data is not stored inline: the pages of a buffer pool are small descriptors pointing into the pool's frame
+ * arena, and a page created on its own allocates a PAGE_SIZE aligned block for its data.
  */
 class Page {
   // There is bookkeeping information inside the page that should only be relevant to the buffer pool manager.
@@ -20,11 +24,15 @@ class Page {
  public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a page outside of a buffer pool. Allocates the page data and zeros it out. */
+  Page() : owns_data_(true), data_(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE))) { ResetMemory(); }
 
-  /** Default destructor. */
-  ~Page() = default;
+  /** Destructor. Frees the page data if the page allocated it. */
+  ~Page() {
+    if (owns_data_) {
+      std::free(data_);
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
@@ -38,6 +46,12 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
+  /** @return whether the page is stored compressed when it is written back */
+  inline bool IsCompressed() { return compressed_; }
+
+  /** Set whether the page is stored compressed from its next write on, e.g. by the table heap that owns it. */
+  inline void SetCompressed(bool compressed) { compressed_ = compressed; }
+
   /** Acquire the page write latch. */
   //inline void WLatch() { rwlatch_.WLock(); }
   inline void WLatch() { }
@@ -69,17 +83,24 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Constructor for a frame of a buffer pool, data points into the pool's frame arena. */
+  explicit Page(char *data) : data_(data) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** True if the page is written back compressed, set when it was read compressed. */
+  bool compressed_ = false;
+  /** Whether data_ was allocated by the page itself rather than by a frame arena. */
+  bool owns_data_ = false;
+  /** The actual data that is stored within a page, PAGE_SIZE aligned. */
+  char *data_;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
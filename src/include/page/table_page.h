@@ -9,12 +9,26 @@
  *                                free space pointer
  *
  *  Header format (size in bytes):
- *  ----------------------------------------------------------------------------
- *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
- *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  -----------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer (2)| FreeSlotList (2) |
+ *  -----------------------------------------------------------------------------------------------
+ *  The first page of a table heap keeps the page id of the heap's free space map in the LSN field, which table pages
+ *  do not use otherwise.
+ *  --------------------------------------------------------------------------------------
+ *  | TupleCount (2) | FragmentedBytes (2) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  --------------------------------------------------------------------------------------
+ *
+ *  The slots of deleted tuples are kept in a doubly linked free list, so that an insert takes one without searching
+ *  the slot array. The offset field of a free slot holds the numbers of the next and the previous free slot plus one
+ *  in its low and high half, 0 for none. FreeSlotList holds the first free slot plus one in the same way, and
+ *  FREE_SLOT_LIST_FLAG once the page keeps the list: pages written before the list existed, with the two halves of the
+ *  header still 0 and size 0 in their free slots, link their free slots on their first change.
+ *
+ *  A delete leaves the bytes of its tuple where they are, as a hole counted in FragmentedBytes, instead of moving the
+ *  tuples below it and rewriting their offsets. The size field of the freed slot holds FREE_MASK and the offset and
+ *  size of the hole, so that the next insert, which takes the slot freed last, can fill the hole right away. The holes
+ *  are free space like the gap between the slots and the tuples; an insert or update that needs them otherwise packs
+ *  all tuples against the end of the page in one pass, which forgets the holes of the free slots.
  **/
 
 #include <cstring>
@@ -54,27 +68,72 @@ class TablePage : public Page {
 
   void ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
+  /**
+   * Remove the tuples marked deleted, pack the remaining ones against the end of the page, and drop the empty slots at
+   * the end of the slot array. The slots of the remaining tuples keep their numbers. Marked deletes can no longer be
+   * rolled back afterwards.
+   * @return the number of tuples removed
+   */
+  uint32_t Vacuum();
+
   void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * @return the serialized bytes of the tuple in a slot, to be read in place with a RowView; nullptr if the slot holds
+   *         no tuple or a deleted one. They stay valid while the page is pinned and the tuple is not changed.
+   */
+  const char *GetTupleData(const RowId &rid);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
 	bool IsEmpty(){ return GetTupleCount() == 0;}
+
+  /** @return the bytes left for tuples and their slots, including the holes deleted tuples left */
+  uint32_t GetFreeSpaceRemaining() { return GetContiguousFreeSpace() + GetFragmentedBytes(); }
+
+  /** @return the free bytes a page needs to take a tuple of tuple_size bytes */
+  static constexpr uint32_t GetSpaceNeeded(uint32_t tuple_size) { return tuple_size + SIZE_TUPLE; }
+
+  /** @return the first page of the free space map of the heap this page is the first page of, 0 if there is none */
+  page_id_t GetFreeSpaceMapPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_LSN); }
+
+  void SetFreeSpaceMapPageId(page_id_t page_id) { memcpy(GetData() + OFFSET_LSN, &page_id, sizeof(page_id_t)); }
+
  private:
-  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
-    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+    auto value = static_cast<uint16_t>(free_space_pointer);
+    memcpy(GetData() + OFFSET_FREE_SPACE, &value, sizeof(uint16_t));
+  }
+
+  uint32_t GetFreeSlotList() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_FREE_SLOT_LIST); }
+
+  void SetFreeSlotList(uint32_t free_slot_list) {
+    auto value = static_cast<uint16_t>(free_slot_list);
+    memcpy(GetData() + OFFSET_FREE_SLOT_LIST, &value, sizeof(uint16_t));
   }
 
-  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_TUPLE_COUNT); }
 
-  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+  void SetTupleCount(uint32_t tuple_count) {
+    auto value = static_cast<uint16_t>(tuple_count);
+    memcpy(GetData() + OFFSET_TUPLE_COUNT, &value, sizeof(uint16_t));
+  }
+
+  uint32_t GetFragmentedBytes() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_FRAGMENTED_BYTES); }
+
+  void SetFragmentedBytes(uint32_t fragmented_bytes) {
+    auto value = static_cast<uint16_t>(fragmented_bytes);
+    memcpy(GetData() + OFFSET_FRAGMENTED_BYTES, &value, sizeof(uint16_t));
+  }
 
-  uint32_t GetFreeSpaceRemaining() {
+  /** @return the bytes between the slot array and the tuples */
+  uint32_t GetContiguousFreeSpace() {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
 
@@ -94,7 +153,50 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
   }
 
-  static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
+  /** @return the next free slot after a free slot, NO_SLOT at the end of the list */
+  uint32_t GetNextFreeSlot(uint32_t slot_num) { return (GetTupleOffsetAtSlot(slot_num) & 0xffff) - 1; }
+
+  /** @return the free slot before a free slot, NO_SLOT at the start of the list */
+  uint32_t GetPrevFreeSlot(uint32_t slot_num) { return (GetTupleOffsetAtSlot(slot_num) >> 16) - 1; }
+
+  void SetFreeSlotLinks(uint32_t slot_num, uint32_t next_slot_num, uint32_t prev_slot_num) {
+    SetTupleOffsetAtSlot(slot_num, ((next_slot_num + 1) & 0xffff) | ((prev_slot_num + 1) << 16));
+  }
+
+  /** @return the first free slot, NO_SLOT if there is none */
+  uint32_t GetFirstFreeSlot() { return (GetFreeSlotList() & ~FREE_SLOT_LIST_FLAG) - 1; }
+
+  void SetFirstFreeSlot(uint32_t slot_num) { SetFreeSlotList(FREE_SLOT_LIST_FLAG | ((slot_num + 1) & 0xffff)); }
+
+  /** Link the free slots of a page that was written before pages kept a free slot list. */
+  void LinkFreeSlots();
+
+  /** Add an empty slot to the front of the free slot list. */
+  void PushFreeSlot(uint32_t slot_num);
+
+  /** Take a slot out of the free slot list. */
+  void UnlinkFreeSlot(uint32_t slot_num);
+
+  /** Drop the empty slots at the end of the slot array, so that a page whose tuples are all gone is empty. */
+  void TrimEmptySlots();
+
+  /** Pack the tuples against the end of the page, so that the holes between them join the contiguous free space. */
+  void Compact();
+
+  /** @return the offset of the hole the last tuple of a free slot left, valid if its size is not 0 */
+  uint32_t GetHoleOffset(uint32_t slot_num) { return (GetTupleSize(slot_num) >> 15) & 0x7fff; }
+
+  /** @return the size of the hole the last tuple of a free slot left, 0 if there is none */
+  uint32_t GetHoleSize(uint32_t slot_num) { return IsFree(GetTupleSize(slot_num)) ? GetTupleSize(slot_num) & 0x7fff : 0; }
+
+  /** Free a slot, recording the hole its tuple left. */
+  void SetFreeSlotHole(uint32_t slot_num, uint32_t hole_offset, uint32_t hole_size) {
+    SetTupleSize(slot_num, static_cast<uint32_t>(FREE_MASK) | (hole_offset << 15) | hole_size);
+  }
+
+  static bool IsFree(uint32_t tuple_size) { return tuple_size == 0 || static_cast<bool>(tuple_size & FREE_MASK); }
+
+  static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || IsFree(tuple_size); }
 
   static uint32_t SetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size | DELETE_MASK); }
 
@@ -103,14 +205,22 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
+  static constexpr uint64_t FREE_MASK = (1U << (8 * sizeof(uint32_t) - 2));
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
+  static constexpr size_t OFFSET_FREE_SLOT_LIST = 18;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
+  static constexpr size_t OFFSET_FRAGMENTED_BYTES = 22;
   static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
   static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr uint32_t FREE_SLOT_LIST_FLAG = 0x8000;
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;
+  // the 16 bit header fields and free slot links hold any offset, slot number plus one, or byte count of a page, and
+  // the 15 bit halves of a hole any offset or size of a tuple
+  static_assert(PAGE_SIZE <= 0x8000 && (PAGE_SIZE - SIZE_TABLE_PAGE_HEADER) / SIZE_TUPLE < 0x7fff);
 
  public:
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
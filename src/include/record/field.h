@@ -20,10 +20,13 @@ class Field {
   friend class TypeFloat;
 
  public:
+  /** Managed chars of at most this many bytes are kept in the field, without an allocation. */
+  static constexpr uint32_t INLINE_CHARS_SIZE = 16;
+
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
   ~Field() {
-    if (type_id_ == TypeId::kTypeChar && manage_data_) {
+    if (OwnsChars()) {
       delete[] value_.chars_;
     }
   }
@@ -51,35 +54,58 @@ class Field {
       value_.chars_ = nullptr;
       manage_data_ = false;
     } else {
+      len_ = len;
       if (manage_data) {
         ASSERT(len < VARCHAR_MAX_LEN, "Field length exceeds max varchar length");
-        value_.chars_ = new char[len];
-        memcpy(value_.chars_, data, len);
+        if (OwnsChars()) {
+          value_.chars_ = new char[len];
+          memcpy(value_.chars_, data, len);
+        } else {
+          memcpy(value_.inline_chars_, data, len);
+        }
       } else {
         value_.chars_ = data;
       }
-      len_ = len;
     }
   }
 
-  // copy constructor
-  Field(const Field &other) {
-    type_id_ = other.type_id_;
-    len_ = other.len_;
-    is_null_ = other.is_null_;
-    manage_data_ = other.manage_data_;
-    if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
+  // copy constructor, short managed chars come with value_
+  Field(const Field &other)
+      : value_(other.value_),
+        type_id_(other.type_id_),
+        len_(other.len_),
+        is_null_(other.is_null_),
+        manage_data_(other.manage_data_) {
+    if (OwnsChars()) {
       value_.chars_ = new char[len_];
       memcpy(value_.chars_, other.value_.chars_, len_);
-    } else {
-      value_ = other.value_;
     }
   }
 
-  
+  // move constructor, takes over allocated chars and leaves other null
+  Field(Field &&other) noexcept
+      : value_(other.value_),
+        type_id_(other.type_id_),
+        len_(other.len_),
+        is_null_(other.is_null_),
+        manage_data_(other.manage_data_) {
+    if (OwnsChars()) {
+      other.value_.chars_ = nullptr;
+      other.len_ = 0;
+      other.is_null_ = true;
+      other.manage_data_ = false;
+    }
+  }
 
   // copy
-  Field &operator=(Field &other) {
+  Field &operator=(const Field &other) {
+    Field copy(other);
+    Swap(*this, copy);
+    return *this;
+  }
+
+  // move
+  Field &operator=(Field &&other) noexcept {
     Swap(*this, other);
     return *this;
   }
@@ -141,23 +167,36 @@ class Field {
       return std::to_string(value_.float_);
     else {
       char temp[len_ + 1];
-      memcpy(temp, value_.chars_, len_);
+      memcpy(temp, GetChars(), len_);
       temp[len_] = '\0';
       return {temp};
     }
   }
 
+ private:
+  /** @return whether the field deletes its chars, managed ones too long to be kept inline */
+  inline bool OwnsChars() const {
+    return type_id_ == TypeId::kTypeChar && manage_data_ && !is_null_ && len_ > INLINE_CHARS_SIZE;
+  }
+
+  inline const char *GetChars() const {
+    return type_id_ == TypeId::kTypeChar && manage_data_ && !is_null_ && len_ <= INLINE_CHARS_SIZE
+               ? value_.inline_chars_
+               : value_.chars_;
+  }
+
 //protected:
 public:
 	union Val {
     int32_t integer_;
     float float_;
     char *chars_;
+    char inline_chars_[INLINE_CHARS_SIZE];  // the chars of a short managed CHAR
   } value_;
   TypeId type_id_;
   uint32_t len_;
   bool is_null_{false};
-  bool manage_data_{false};  //if true, the chars_ is a deep-ptr  else is a shallow-ptr
+  bool manage_data_{false};  //if true, the chars are a deep copy, kept inline if short, else a shallow-ptr
 };
 
 #endif  // MINISQL_FIELD_H
@@ -11,7 +11,17 @@
 #include "common/heap.h"
 using namespace std;
 /**
- *  Row format:
+ *  Row format v2, written by SerializeTo:
+ * ----------------------------------------------------------------------------
+ * | Version | Null bitmap | Fixed area | Offset array | CHAR-1 | ... | CHAR-M |
+ * ----------------------------------------------------------------------------
+ *  Version is the uint16 ROW_FORMAT_V2. The null bitmap has a bit per column of the schema, set if the value is not
+ *  null. The fixed area holds the value of every INT and FLOAT column at the offset the schema computes for it,
+ *  zeros for a null one. The offset array holds a uint16 per CHAR column, where its characters end in the row; a
+ *  CHAR value starts where the one before it ends, or after the offset array, and a null one is empty. So the value
+ *  of any column is found without looking at the columns before it, see RowView.
+ *
+ *  Row format v1, written before v2 and still read:
  * -------------------------------------------
  * | Header | Field-1 | ... | Field-N |
  * -------------------------------------------
@@ -19,103 +29,102 @@ using namespace std;
  * --------------------------------------------
  * | Field Nums | Null bitmap |
  * -------------------------------------------
- *
- *
+ *  Field Nums is a uint32, the fields are packed one after the other, a CHAR as its uint32 length and characters,
+ *  and null fields take no space. A v1 row would need more than 65000 columns to start with ROW_FORMAT_V2.
  */
+/** The first two bytes of a row in format v2, see above. */
+static constexpr uint16_t ROW_FORMAT_V2 = 0xFFF2;
+
 class Row {
  public:
   /**
    * Row used for insert
    * Field integrity should check by upper level
    */
-  Row(std::vector<Field> &fields): col_heap_(new SimpleMemHeap) {
-    // deep copy   but for char*, maybe shallow 
+  Row(std::vector<Field> &fields) {
+    //deep copy, a CHAR field's characters too
     for (auto &field : fields) {
-      //fields_.push_back(new Field(field));   
-			//version 2 : allocate from mem heap
-			Field* f = ALLOC_P(col_heap_, Field)(field);
-			fields_.push_back(f);
-    }
-  }
-
-  void destroy() {
-		/*
-    if (!fields_.empty()) {
-      for (auto field : fields_) {
-        delete field;
-      }
-      fields_.clear();
+			fields_.push_back(CopyField(field));
     }
-		*/
-		delete col_heap_; //when delete mem_heap, all the memory allocate by this mem-heap will be free!!
   }
 
-  ~Row() { destroy(); };
+  ~Row() = default;
 
   /**
    * Row used for deserialize
    */
-  //Row() = default;
-	Row(): rid_(INVALID_ROWID), col_heap_(new SimpleMemHeap)
+	Row(): rid_(INVALID_ROWID)
 	{}
 
   /**
    * Row used for deserialize and update
    */
-	//NOTE: initialize the heap!!!
-  Row(RowId rid) : rid_(rid), col_heap_(new SimpleMemHeap) {}
+  Row(RowId rid) : rid_(rid) {}
+
+  /**
+   * Row whose fields are allocated from heap, e.g. the arena of a query, which must outlive the row
+   */
+  Row(RowId rid, MemHeap *heap) : rid_(rid), col_heap_(heap) {}
 
   /**
    * Row copy function, deep copy
    */
-  Row(const Row &other):col_heap_(new SimpleMemHeap) {  //note : every Row must have its own mem-heap!!
-    /*
-		destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
-    }
-		*/
-		rid_ = other.rid_;
-		if(!fields_.empty())
-		{ //clear
-			for(auto & ele : fields_)
-				col_heap_->Free(ele); 
-			fields_.clear();
-		}
+  Row(const Row &other) : rid_(other.rid_) {  //note : a copy allocates from its own heap
+		CopyFields(other);
+  }
 
-		for(auto& ele : other.fields_)
-		{
-			Field* f = ALLOC_P(col_heap_, Field)(*ele);
-			fields_.push_back(f);
-		}
+  /**
+   * Deep copy whose fields are allocated from heap, which must outlive the row
+   */
+  Row(const Row &other, MemHeap *heap) : rid_(other.rid_), col_heap_(heap) {
+		CopyFields(other);
   }
 
+  /**
+   * Move constructor, takes over the fields of other and the heap they live in
+   */
+  Row(Row &&other) noexcept
+      : rid_(other.rid_),
+        fields_(std::move(other.fields_)),
+        own_heap_(std::move(other.own_heap_)),
+        col_heap_(other.col_heap_ == &other.own_heap_ ? &own_heap_ : other.col_heap_) {}
+
   /**
    * Assign operator, deep copy
    */
   Row &operator=(const Row &other) {
-    /*
-		destroy(); 
+		if(this == &other)
+			return *this;
 		rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
-    }
-		*/
+		ClearFields();
+		CopyFields(other);
+    return *this;
+  }
+
+  /**
+   * Move assign operator, takes over the fields of other and the heap they live in
+   */
+  Row &operator=(Row &&other) noexcept {
+		if(this == &other)
+			return *this;
 		rid_ = other.rid_;
-		if(!fields_.empty())
-		{ //clear
-			for(auto & ele : fields_)
-				col_heap_->Free(ele); 
-			fields_.clear();
+		ClearFields();
+		if(other.col_heap_ != &other.own_heap_)
+		{
+			col_heap_ = other.col_heap_;
+			fields_.swap(other.fields_);
 		}
-
-		for(auto& ele : other.fields_)
+		else if(!other.fields_.empty())
 		{
-			Field* f = ALLOC_P(col_heap_, Field)(*ele);
-			fields_.push_back(f);
+			own_heap_ = std::move(other.own_heap_);
+			col_heap_ = &own_heap_;
+			fields_.swap(other.fields_);
+		}
+		else
+		{
+			//nothing to take over, e.g. Row(rid), the memory of the own heap is kept for the next fields
+			col_heap_ = &own_heap_;
 		}
-
     return *this;
   }
 
@@ -135,6 +144,9 @@ class Row {
 
   void GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row);
 
+  /** @return the size of the null bitmap of a row with column_count columns */
+  static inline uint32_t GetNullBitmapSize(uint32_t column_count) { return (column_count + 7) / 8; }
+
   inline const RowId GetRowId() const { return rid_; }
 
   inline void SetRowId(RowId rid) { rid_ = rid; }
@@ -149,9 +161,27 @@ class Row {
   inline size_t GetFieldCount() const { return fields_.size(); }
 
  private:
+  /** Read a row in format v1. */
+  uint32_t DeserializeFromV1(char *buf, Schema *schema);
+
+  /** @return a copy of field allocated from col_heap_, for a CHAR field with its characters */
+  Field *CopyField(const Field &field);
+
+  /** @return a CHAR field whose len characters are copied from data into col_heap_ */
+  Field *NewCharField(const char *data, uint32_t len);
+
+  void CopyFields(const Row &other);
+
+  /** Drop the fields, the memory of an own heap is given back for the next ones. */
+  void ClearFields();
+
+  /** The first chunk of own_heap_ fits the fields of a typical row. */
+  static constexpr size_t ROW_HEAP_CHUNK_SIZE = 256;
+
   RowId rid_{};
-  std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
-	MemHeap * col_heap_{nullptr};
+  std::vector<Field *> fields_; /** allocated from col_heap_, never destructed */
+	ArenaMemHeap own_heap_{ROW_HEAP_CHUNK_SIZE};  //chunks are only malloced once a field is allocated
+	MemHeap * col_heap_{&own_heap_};
 };
 
 #endif  // MINISQL_ROW_H
@@ -0,0 +1,137 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <string_view>
+
+#include "common/macros.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * RowView reads the fields of a row in place from its serialized bytes, see Row for the formats, e.g. a tuple in a
+ * pinned TablePage or a GenericKey. Nothing is allocated or copied: CHAR values come back as string_views and as
+ * Fields that point into the bytes, so they are only valid as long as the bytes are.
+ *
+ * In a row of format v2 any column is found in O(1) from the layout the schema computes. In a row of format v1 a
+ * column's offset is found by walking the columns before it; the view remembers where the last column it resolved
+ * starts, which makes reading the columns in order cost one step each.
+ */
+class RowView {
+ public:
+  RowView(const char *data, const Schema *schema) : data_(data), schema_(schema) {
+    if (MACH_READ_FROM(uint16_t, data) == ROW_FORMAT_V2) {
+      v2_ = true;
+      field_count_ = schema->GetColumnCount();
+      bitmap_ = data + sizeof(uint16_t);
+      fixed_ = bitmap_ + Row::GetNullBitmapSize(field_count_);
+      offsets_ = fixed_ + schema->GetFixedSize();
+    } else {
+      field_count_ = MACH_READ_UINT32(data);
+      bitmap_ = data + sizeof(uint32_t);
+      cursor_offset_ = FirstFieldOffset();
+    }
+  }
+
+  inline uint32_t GetFieldCount() const { return field_count_; }
+
+  inline bool IsNull(uint32_t column) const {
+    ASSERT(column < field_count_, "Failed to access field");
+    return (bitmap_[column / 8] & (0x80 >> (column % 8))) == 0;
+  }
+
+  /** The getters below must only be called for a column of their type that is not null. */
+  inline int32_t GetInt(uint32_t column) const { return MACH_READ_INT32(GetFixedValue(column)); }
+
+  inline float GetFloat(uint32_t column) const { return MACH_READ_FROM(float, GetFixedValue(column)); }
+
+  inline std::string_view GetChars(uint32_t column) const {
+    if (v2_) {
+      uint32_t index = schema_->GetRowLayout(column);
+      uint32_t end = MACH_READ_FROM(uint16_t, offsets_ + index * sizeof(uint16_t));
+      uint32_t start = index == 0 ? offsets_ - data_ + schema_->GetVarColumnCount() * sizeof(uint16_t)
+                                  : MACH_READ_FROM(uint16_t, offsets_ + (index - 1) * sizeof(uint16_t));
+      return {data_ + start, end - start};
+    }
+    const char *value = data_ + GetV1Offset(column);
+    return {value + sizeof(uint32_t), MACH_READ_UINT32(value)};
+  }
+
+  /** @return the field of a column, a CHAR field points into the row's bytes */
+  Field GetField(uint32_t column) const {
+    TypeId type = schema_->GetColumn(column)->GetType();
+    if (IsNull(column)) {
+      return Field(type);
+    }
+    switch (type) {
+      case TypeId::kTypeInt:
+        return Field(type, GetInt(column));
+      case TypeId::kTypeFloat:
+        return Field(type, GetFloat(column));
+      default: {
+        std::string_view chars = GetChars(column);
+        return Field(type, const_cast<char *>(chars.data()), chars.size(), false);
+      }
+    }
+  }
+
+  /**
+   * Compare a column with the same column of another row of the same schema.
+   * @return less than, equal to or greater than 0 as the column orders before, with or after the other's; a column
+   *         that is null in either row compares equal
+   */
+  int CompareColumn(uint32_t column, const RowView &other) const {
+    if (IsNull(column) || other.IsNull(column)) {
+      return 0;
+    }
+    switch (schema_->GetColumn(column)->GetType()) {
+      case TypeId::kTypeInt: {
+        int32_t lhs = GetInt(column), rhs = other.GetInt(column);
+        return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+      }
+      case TypeId::kTypeFloat: {
+        float lhs = GetFloat(column), rhs = other.GetFloat(column);
+        return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+      }
+      default:
+        return GetChars(column).compare(other.GetChars(column));
+    }
+  }
+
+ private:
+  inline uint32_t FirstFieldOffset() const { return sizeof(uint32_t) + Row::GetNullBitmapSize(field_count_); }
+
+  inline const char *GetFixedValue(uint32_t column) const {
+    return v2_ ? fixed_ + schema_->GetRowLayout(column) : data_ + GetV1Offset(column);
+  }
+
+  /** @return the offset of a column's value in a row of format v1 */
+  uint32_t GetV1Offset(uint32_t column) const {
+    ASSERT(column < field_count_, "Failed to access field");
+    if (column < cursor_column_) {
+      cursor_column_ = 0;
+      cursor_offset_ = FirstFieldOffset();
+    }
+    for (; cursor_column_ < column; cursor_column_++) {
+      if (IsNull(cursor_column_)) {
+        continue;
+      }
+      TypeId type = schema_->GetColumn(cursor_column_)->GetType();
+      cursor_offset_ += type == TypeId::kTypeChar ? sizeof(uint32_t) + MACH_READ_UINT32(data_ + cursor_offset_)
+                                                  : Type::GetTypeSize(type);
+    }
+    return cursor_offset_;
+  }
+
+  const char *data_;
+  const Schema *schema_;
+  bool v2_{false};
+  uint32_t field_count_;
+  const char *bitmap_;
+  const char *fixed_{nullptr};    // v2: the fixed area
+  const char *offsets_{nullptr};  // v2: the offset array
+  mutable uint32_t cursor_column_{0};  // v1: the last column GetV1Offset resolved
+  mutable uint32_t cursor_offset_{0};  // and the offset of its value
+};
+
+#endif  // MINISQL_ROW_VIEW_H
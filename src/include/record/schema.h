@@ -14,7 +14,18 @@ using namespace std;
 class Schema {
  public:
   explicit Schema(const std::vector<Column *> columns, bool is_manage_ = true)
-      : columns_(std::move(columns)), is_manage_(is_manage_) {}  //note:std move!!!!
+      : columns_(std::move(columns)), is_manage_(is_manage_) {  //note:std move!!!!
+    // lay out the values of rows in the v2 format, see Row
+    row_layout_.reserve(columns_.size());
+    for (auto column : columns_) {
+      if (column->GetType() == TypeId::kTypeChar) {
+        row_layout_.push_back(var_column_count_++);
+      } else {
+        row_layout_.push_back(fixed_size_);
+        fixed_size_ += Type::GetTypeSize(column->GetType());
+      }
+    }
+  }
 
   ~Schema() {
     if (is_manage_) {
@@ -40,6 +51,18 @@ class Schema {
 
   inline uint32_t GetColumnCount() const { return static_cast<uint32_t>(columns_.size()); }
 
+  /**
+   * @return where a row in the v2 format keeps the value of a column: for a fixed-width column its offset in the fixed
+   *         area, for a CHAR column its index in the offset array
+   */
+  inline uint32_t GetRowLayout(const uint32_t column_index) const { return row_layout_[column_index]; }
+
+  /** @return the size of the fixed area of a row in the v2 format, holding the values of the fixed-width columns */
+  inline uint32_t GetFixedSize() const { return fixed_size_; }
+
+  /** @return the number of CHAR columns, which a row in the v2 format keeps after its fixed area */
+  inline uint32_t GetVarColumnCount() const { return var_column_count_; }
+
   /**
    * Shallow copy schema, only used in index
    *
@@ -95,6 +118,9 @@ class Schema {
   static constexpr uint32_t SCHEMA_MAGIC_NUM = 200715;
   std::vector<Column *> columns_;
   bool is_manage_ = false; /** if false, don't need to delete pointer to column */
+  std::vector<uint32_t> row_layout_;  // see GetRowLayout
+  uint32_t fixed_size_{0};
+  uint32_t var_column_count_{0};
 };
 
 using IndexSchema = Schema;
@@ -0,0 +1,98 @@
+#ifndef MINISQL_ASYNC_IO_H
+#define MINISQL_ASYNC_IO_H
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+class DiskManager;
+
+/**
+ * A page read or write handed to an AsyncIO. The request and its data must stay alive until the request is reaped.
+ */
+struct AsyncIORequest {
+  bool is_write_{false};
+  page_id_t page_id_{INVALID_PAGE_ID};  // logical page id, like DiskManager::ReadPage and WritePage take
+  char *data_{nullptr};                 // PAGE_SIZE bytes to read into or to write out
+  int result_{0};                       // 0 once the request succeeded, -errno if it failed
+  void *user_data_{nullptr};            // not touched by AsyncIO, lets the submitter find its own state again
+  bool compressed_{false};              // set by a read of a page that was stored compressed, see DiskManager
+};
+
+enum class AsyncIOType { AUTO = 0, IO_URING, THREAD_POOL };
+
+/**
+ * AsyncIO keeps up to queue_depth page reads and writes of a DiskManager in flight at once. Submit hands a batch of
+ * requests to the kernel, or to a pool of I/O threads, and returns right away; Reap waits for requests to complete.
+ *
+ * The io_uring backend is used when the kernel supports it, the thread pool backend otherwise. Either way a request
+ * behaves like the synchronous DiskManager call: reading a page past the end of the file yields a zeroed page, reading
+ * a compressed page yields its decompressed image, and a transfer the kernel only did in part is finished
+ * synchronously when the request is reaped. Writes are never compressed.
+ *
+ * An AsyncIO must only be used by one thread at a time and must not outlive its disk manager. Destroying an AsyncIO
+ * waits for the requests still in flight.
+ */
+class AsyncIO {
+ public:
+  /**
+   * @param disk_manager the disk manager whose file the requests go to
+   * @param queue_depth maximum number of requests in flight
+   * @param type backend to use, AUTO picks io_uring if available. A backend that can not be set up falls back to
+   *        the thread pool.
+   */
+  static AsyncIO *Create(DiskManager *disk_manager, size_t queue_depth = DEFAULT_IO_QUEUE_DEPTH,
+                         AsyncIOType type = AsyncIOType::AUTO);
+
+  virtual ~AsyncIO() = default;
+
+  DISALLOW_COPY_AND_MOVE(AsyncIO);
+
+  /**
+   * Start a batch of requests.
+   * @return the number of requests started, the first ones of the batch. Fewer than count once queue_depth
+   *         requests are in flight.
+   */
+  virtual size_t Submit(AsyncIORequest *const *requests, size_t count) = 0;
+
+  /**
+   * Wait until at least min_count requests completed, or every request in flight did, and collect up to
+   * max_count completed requests.
+   * @return the number of requests stored in completed
+   */
+  virtual size_t Reap(AsyncIORequest **completed, size_t max_count, size_t min_count) = 0;
+
+  /** @return the backend actually in use, never AUTO */
+  virtual AsyncIOType GetType() const = 0;
+
+  /** @return the maximum number of requests in flight */
+  size_t GetQueueDepth() const { return queue_depth_; }
+
+  /** @return the number of requests submitted but not reaped yet */
+  size_t GetInFlight() const { return in_flight_; }
+
+ protected:
+  AsyncIO(DiskManager *disk_manager, size_t queue_depth);
+
+  /** @return the descriptor of the db file */
+  int GetFd() const;
+
+  /** @return the offset of a logical page in the db file */
+  size_t GetPageOffset(page_id_t page_id) const;
+
+  /**
+   * Complete a request of which the backend transferred done bytes, a negative value being an error: transfer the
+   * rest synchronously, zero what a read found past the end of the file, decompress a page that was stored
+   * compressed and set the request's result.
+   */
+  void FinishRequest(AsyncIORequest *request, ssize_t done);
+
+  DiskManager *disk_manager_;
+  size_t queue_depth_;
+  size_t in_flight_{0};
+};
+
+#endif  // MINISQL_ASYNC_IO_H
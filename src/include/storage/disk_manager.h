@@ -2,16 +2,27 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
 
+/**
+ * A run of contiguous logical pages that DiskManager reserved for one table heap or index, see
+ * DiskManager::AllocatePage(AllocationRun *). An empty run has next_ == end_.
+ */
+struct AllocationRun {
+  page_id_t next_{INVALID_PAGE_ID};  // next reserved page to hand out
+  page_id_t end_{INVALID_PAGE_ID};   // one past the last reserved page
+};
+
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -19,10 +30,48 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * The meta page holds the used page counts of the first DiskFileMetaPage::MAX_EXTENTS extents; the counts of the
+ * other extents are kept in a chain of overflow pages, which are ordinary logical pages allocated on demand. Physical
+ * page ids and file offsets are 64 bit, so the file can grow until the logical page ids run out at
+ * MAX_VALID_PAGE_ID. Files with the version 1 meta page, limited to DiskFileMetaPage::V1_MAX_EXTENTS extents, are
+ * upgraded when they are opened. The meta page also records PAGE_SIZE, which is a build option, and a file is only
+ * opened by a build with the same page size.
+ *
+ * Pages are read and written with positional pread/pwrite on a file descriptor, so page I/O from different threads
+ * runs concurrently. Only allocation, which updates the meta page and the bitmaps, is serialized by db_io_latch_.
+ *
+ * The meta pages and the bitmap pages stay in memory once read. Allocation only changes the cached copies and marks
+ * them dirty; FlushMetadata, which the buffer pool calls when it flushes all pages, writes them back together.
+ *
+ * Freeing a page only clears its bit in the bitmap. ReclaimSpace releases the disk space of the free pages, e.g. after
+ * a table was dropped.
+ *
+ * Owners of many pages, like a table heap, allocate through an AllocationRun. The disk manager then reserves
+ * allocation_run_pages_ contiguous pages inside one extent for the owner and hands them out in order, so that the
+ * owner's pages lie next to each other in the file even while other owners allocate too. Reservations only exist in
+ * memory; the pages of a run that were not handed out are free again once the file is reopened.
+ *
+ * Pages written with compression are stored as a CompressedPageHeader and the PageCompressor output, padded to the
+ * file system block size; the rest of the page's slot is punched out of the file, so the slot only occupies the
+ * blocks the compressed image needs. A page is addressed by its logical page id as before, only its allocated size
+ * varies, and reading it restores the full page, which ReadPage reports as compressed. Compression only saves space
+ * when pages span several file system blocks, i.e. with a PAGE_SIZE larger than the block size.
+ *
+ * In direct I/O mode the file is opened with O_DIRECT, so pages bypass the kernel page cache and are only cached by
+ * the buffer pool. Page buffers that are not PAGE_SIZE aligned, unlike the buffer pool's frames, are copied through
+ * an aligned buffer on the stack.
  */
 class DiskManager {
+  friend class AsyncIO;
+
  public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param db_file path of the db file, created if it does not exist
+   * @param direct_io whether to bypass the kernel page cache. Falls back to buffered I/O if the file system does
+   *        not support O_DIRECT.
+   */
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   ~DiskManager() {
     if (!closed) {
@@ -31,23 +80,42 @@ class DiskManager {
   }
 
   /**
-   * Read page from specific page_id
+   * Read page from specific page_id, decompressing it if it was written compressed
    * Note: page_id = 0 is reserved for free page bit map
+   * @return whether the page was stored compressed
    */
-  void ReadPage(page_id_t logical_page_id, char *page_data);
+  bool ReadPage(page_id_t logical_page_id, char *page_data);
 
   /**
    * Write data to specific page
    * Note: page_id = 0 is reserved for free page bit map
+   * @param compress whether to store the page compressed. It is stored as is if it does not compress at all.
    */
-  void WritePage(page_id_t logical_page_id, const char *page_data);
+  void WritePage(page_id_t logical_page_id, const char *page_data, bool compress = false);
 
   /**
    * Get next free page from disk
-   * @return logical page id of allocated page
+   * @return logical page id of allocated page, INVALID_PAGE_ID if the logical page ids are used up
    */
   page_id_t AllocatePage();
 
+  /**
+   * Get the next page of an allocation run, reserving a new run first if it is used up. Falls back to AllocatePage()
+   * when no extent has room for a whole run.
+   * @return logical page id of allocated page
+   */
+  page_id_t AllocatePage(AllocationRun *run);
+
+  /**
+   * Free the pages of a run that were not handed out yet and empty the run.
+   */
+  void ReleaseRun(AllocationRun *run);
+
+  /**
+   * Set the number of pages reserved per allocation run, rounded down to a multiple of 8. 0 turns runs off.
+   */
+  void SetAllocationRunPages(uint32_t pages);
+
   /**
    * Free this page and reset bit map
    */
@@ -59,7 +127,20 @@ class DiskManager {
   bool IsPageFree(page_id_t logical_page_id);
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Write the dirty bitmap pages, then the dirty overflow meta pages and then the meta page back to the file.
+   */
+  void FlushMetadata();
+
+  /**
+   * Give the space of free pages back to the file system: punch the runs of free pages out of the file and truncate
+   * it after the last allocated page. Free pages read as zeros afterwards, like pages that were never written. Pages
+   * are not moved, so a live page near the end of the file keeps the file from shrinking further.
+   * The caller must make sure free pages are not written concurrently, e.g. by dropping their frames first.
+   */
+  void ReclaimSpace();
+
+  /**
+   * Write back the allocation metadata, shut down the disk manager and close all the file resources.
    */
   void Close();
 
@@ -69,37 +150,143 @@ class DiskManager {
    */
   char *GetMetaData() { return meta_data_; }
 
+  /** @return whether the file is accessed with direct I/O */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /** @return the number of allocated pages of an extent, wherever its count is kept */
+  uint32_t GetExtentUsedPages(uint32_t extent_id);
+
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
+  /** number of extents the logical page ids reach */
+  static constexpr uint32_t MAX_EXTENTS = MAX_VALID_PAGE_ID / BITMAP_SIZE;
+
  private:
   /**
-   * Helper function to get disk file size
+   * Start of a page stored compressed. No page starts like this: pages begin with their page id, a small page type
+   * or count, or a magic number, and 0xC0DEC0DE is negative as a page id.
    */
-  int GetFileSize(const std::string &file_name);
+  struct CompressedPageHeader {
+    static constexpr uint32_t MAGIC = 0xC0DEC0DE;
+    uint32_t magic_;
+    uint32_t size_;  // size of the compressed data following the header
+  };
 
   /**
    * Read physical page from disk
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  void ReadPhysicalPage(int64_t physical_page_id, char *page_data);
 
   /**
    * Write data to physical page in disk
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  void WritePhysicalPage(int64_t physical_page_id, const char *page_data);
+
+  /**
+   * Write a page compressed to a physical page, or as is if its compressed image would not fit into a page.
+   */
+  void WriteCompressedPage(int64_t physical_page_id, const char *page_data);
+
+  /**
+   * Replace a page read from the file by its decompressed image if it was stored compressed.
+   * @return whether it was stored compressed
+   */
+  bool DecompressPage(char *page_data);
 
   /**
    * Map logical page id to physical page id
    */
-  page_id_t MapPageId(page_id_t logical_page_id);
+  int64_t MapPageId(page_id_t logical_page_id);
+
+  /**
+   * Reserve allocation_run_pages_ contiguous free pages for a run. The caller must hold db_io_latch_.
+   * @return false if no extent has a free run
+   */
+  bool ReserveRun(AllocationRun *run);
+
+  /** Account for a page of an extent that was handed out. The caller must hold db_io_latch_. */
+  void CountAllocatedPage(uint32_t extent_id);
+
+  /**
+   * @param for_update whether the caller changes the count, which marks its page dirty and adds the overflow pages
+   *        up to the one that holds it
+   * @return the used page count of an extent in its meta page, null if its overflow page does not exist and
+   *         for_update is false. The caller must hold db_io_latch_.
+   */
+  uint32_t *GetExtentUsedPageSlot(uint32_t extent_id, bool for_update);
+
+  /** @return the used page count of an extent, 0 if it is not kept yet. The caller must hold db_io_latch_. */
+  uint32_t ExtentUsedPages(uint32_t extent_id) {
+    uint32_t *slot = GetExtentUsedPageSlot(extent_id, false);
+    return slot == nullptr ? 0 : *slot;
+  }
+
+  /** Allocate a page for another overflow meta page and link it to the end of the chain. */
+  void AddMetaOverflowPage();
+
+  /**
+   * Read the overflow meta pages of a version 2 file, or convert the meta page of a version 1 file.
+   * @return false if the file was written with an unknown format
+   */
+  bool LoadMetadata();
+
+  /** @return the physical page id of the bitmap page of an extent */
+  static int64_t GetBitmapPhysicalPageId(uint32_t extent_id) {
+    return static_cast<int64_t>(extent_id) * (BITMAP_SIZE + 1) + 1;
+  }
+
+  /**
+   * @return the cached bitmap page of an extent, read from the file on first use. The caller must hold
+   *         db_io_latch_.
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Transfer the rest of a page at a byte offset of the file, done bytes of it being transferred already. A read
+   * zeroes what lies past the end of the file.
+   * @return 0 on success, -errno on an I/O error
+   */
+  int TransferPage(bool is_write, size_t offset, char *page_data, size_t done = 0);
+
+  /** Raise the known size of the db file to end, after a page ending there was written. */
+  void GrowFileSize(size_t end);
+
+  /** Punch physical pages [first, last) out of the file, as far as they lie inside it. */
+  void PunchPages(int64_t first, int64_t last);
 
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file
+  int fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // size of the db file in bytes, kept in memory so reads do not have to stat the file
+  std::atomic<size_t> file_size_{0};
+  // whether fd_ was opened with O_DIRECT
+  bool direct_io_{false};
+  // file system block size, the unit compressed pages are stored in
+  size_t block_size_{PAGE_SIZE};
+  // protects the meta page and the bitmap pages
   std::recursive_mutex db_io_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];
+  alignas(PAGE_SIZE) char meta_data_[PAGE_SIZE];
+  bool meta_dirty_{false};
+
+  /** A cached overflow meta page. */
+  struct MetaOverflowPage {
+    alignas(PAGE_SIZE) char data_[PAGE_SIZE];
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool dirty_{false};
+  };
+  std::vector<std::unique_ptr<MetaOverflowPage>> meta_overflow_pages_;  // in the order of the chain
+
+  /** The cached bitmap page of an extent. */
+  struct ExtentBitmap {
+    alignas(PAGE_SIZE) char data_[PAGE_SIZE];
+    bool dirty_{false};
+  };
+  std::vector<std::unique_ptr<ExtentBitmap>> bitmaps_;  // indexed by extent id, null until first used
+  uint32_t first_free_extent_{0};                        // extents below this one are full
+  uint32_t allocation_run_pages_{DEFAULT_ALLOCATION_RUN_PAGES};
+  std::unordered_set<page_id_t> reserved_pages_;  // pages of runs not handed out yet, allocated in bitmaps_ only
 };
 
 #endif
@@ -0,0 +1,101 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/free_space_page.h"
+
+/**
+ * FreeSpaceMap records the free bytes of every page of a table heap, so that an insert finds a page with room without
+ * visiting the heap's pages. It is persistent: the entries live in a chain of FreeSpacePages, each update is written
+ * through to the page holding its entry, and opening a map reads the chain once.
+ *
+ * In memory the entries are kept in the order the pages were added, with a tree of the maximum free space over each
+ * range of them on top. FindPage descends that tree to the first page with enough room in O(log N), which keeps the
+ * heap first-fit: inserts fill the earliest pages with room, like walking the page chain would. Removing a page
+ * leaves its entry empty; once the empty entries outnumber the used ones the map is compacted, keeping the order.
+ *
+ * The map is a hint the heap keeps exact by updating it after every change of a page. Nothing depends on it being
+ * right, though: a page that turns out to be fuller than recorded is just updated and the search repeated. A change
+ * that can not be written because the buffer pool has no frame to spare fails and leaves the map as it was.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * Open the map whose first page is first_page_id, or an empty map that allocates its pages once a page is added.
+   * Check IsLoaded before using an opened map.
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id = INVALID_PAGE_ID);
+
+  /** @return whether every page of the map could be read when it was opened */
+  bool IsLoaded() const { return loaded_; }
+
+  /** @return the id of the map's first page, INVALID_PAGE_ID while no page was added */
+  page_id_t GetFirstPageId() const { return first_page_id_; }
+
+  /** @return the first page added to the heap with at least size free bytes, INVALID_PAGE_ID if there is none */
+  page_id_t FindPage(uint32_t size) const;
+
+  /** @return the page added last that was not removed, INVALID_PAGE_ID if there is none */
+  page_id_t GetLastPageId() const;
+
+  /**
+   * Add a page of the heap.
+   * @return false if the entry could not be written, the map is unchanged then
+   */
+  bool AddPage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Record the free bytes of a page of the heap, adding it if the map does not know it.
+   * @return false if the entry could not be written, the map is unchanged then
+   */
+  bool UpdatePage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Remove a page that is taken out of the heap.
+   * @return false if the entry could not be written, the map is unchanged then and still holds the page
+   */
+  bool RemovePage(page_id_t page_id);
+
+  /** Delete the map's pages. */
+  void Destroy();
+
+  /** @return the number of heap pages in the map */
+  size_t GetPageCount() const { return slots_.size(); }
+
+ private:
+  /** Take over the entries and build the tree over them. */
+  void SetEntries(std::vector<page_id_t> page_ids, const std::vector<uint16_t> &free_spaces);
+
+  /**
+   * Write an entry to the page of the chain holding it, appending a page to the chain if it is the first entry of a
+   * new one. The entry is only written, the caller updates the map in memory once it succeeded.
+   * @return false if a page of the chain could not be fetched or created
+   */
+  bool WriteEntry(size_t entry, page_id_t page_id, uint16_t free_space);
+
+  /**
+   * Drop the empty entries and move the others to the front. The map's pages after the first are written to a new
+   * chain that rewriting the first page switches to, so that the pages on disk are never half compacted.
+   * @return false if a page could not be fetched or created, the map is unchanged then
+   */
+  bool Compact();
+
+  /** Set the free space of an entry in the tree. */
+  void SetTreeValue(size_t entry, uint16_t free_space);
+
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t first_page_id_;
+  std::vector<page_id_t> map_page_ids_;  // the pages of the chain, entry i is kept in page i / CAPACITY
+  std::vector<page_id_t> page_ids_;      // heap page of each entry, INVALID_PAGE_ID once removed
+  std::unordered_map<page_id_t, size_t> slots_;  // entry of each heap page
+  // tree_[1] is the root, the children of node i are 2i and 2i + 1, and the leaves from leaf_base_ on are the
+  // entries' free spaces
+  std::vector<uint16_t> tree_;
+  size_t leaf_base_{1};
+  bool loaded_{true};
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
@@ -0,0 +1,39 @@
+#ifndef MINISQL_PAGE_COMPRESSOR_H
+#define MINISQL_PAGE_COMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * PageCompressor is a small LZ77 codec for page images, in the spirit of LZ4: the output is a sequence of literal
+ * runs, each followed by a back reference of at least MIN_MATCH bytes into the data decoded so far. It needs no
+ * external library and is fast enough to run on every page write. Runs of padding, zeroed free space and repeated
+ * CHAR values, which fill table pages, shrink to a few bytes.
+ *
+ * Format of a sequence: a token byte whose high nibble is the literal length and whose low nibble is the match
+ * length minus MIN_MATCH, a nibble of 15 being continued by bytes that are added up until one is below 255; the
+ * literals; the 2 byte little endian match offset; the match length continuation bytes. The last sequence has
+ * literals only and ends the input.
+ */
+class PageCompressor {
+ public:
+  /**
+   * Compress src_size bytes, which must be at most MAX_INPUT_SIZE.
+   * @return the compressed size, 0 if the output does not fit into dst_capacity bytes
+   */
+  static size_t Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity);
+
+  /**
+   * Decompress exactly dst_size bytes.
+   * @return false if the input is corrupt or does not decompress to dst_size bytes
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dst, size_t dst_size);
+
+  static constexpr size_t MIN_MATCH = 4;
+  static constexpr size_t MAX_INPUT_SIZE = UINT16_MAX;  // offsets are 2 bytes
+
+ private:
+  static constexpr uint32_t HASH_BITS = 12;
+};
+
+#endif  // MINISQL_PAGE_COMPRESSOR_H
@@ -4,10 +4,24 @@
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
+#include "storage/free_space_map.h"
 #include "storage/table_iterator.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "common/heap.h"
+/** What a TableHeap::Vacuum run found and gave back. */
+struct VacuumStats {
+  size_t pages_scanned_{0};
+  size_t tuples_removed_{0};   // tuples that were marked deleted
+  size_t bytes_reclaimed_{0};  // bytes of the removed tuples and of the slots dropped with them
+  size_t pages_freed_{0};      // pages that emptied and were taken out of the heap
+};
+
+/**
+ * A table heap is a doubly linked chain of table pages, starting with a first page that stays for the life of the
+ * heap. Inserts go to the first page with enough room, which a FreeSpaceMap finds without walking the chain; the map
+ * is created on the first change of a heap that has none, e.g. one written before heaps had maps.
+ */
 class TableHeap {
   friend class TableIterator;
 
@@ -25,7 +39,14 @@ class TableHeap {
 		return ALLOC_P(heap, TableHeap)(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
 	}
 
-  ~TableHeap() {}
+  /**
+   * Heaps live in the catalog's arena, which frees their memory without running destructors, so the catalog calls
+   * this for each of its heaps before it frees the arena.
+   */
+  ~TableHeap() {
+    EndAppend();
+    free_space_map_.reset();
+  }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -35,6 +56,21 @@ class TableHeap {
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Append a tuple to the end of the table, for loads. Unlike InsertTuple it does not look for room in earlier pages:
+   * the heap keeps its last page pinned between appends and fills it, links a new page straight to it once it is
+   * full, and marks each page dirty once when it moves on rather than once per tuple. Call EndAppend when done.
+   * @param[in/out] row Tuple Row to append, the rid of the appended tuple is wrapped in object row
+   * @param[in] txn The transaction performing the append
+   * @return true iff the append is successful
+   */
+  bool AppendTuple(Row &row, Transaction *txn);
+
+  /**
+   * Finish appending: record the free space of the last page and unpin it. Does nothing if no append is in progress.
+   */
+  void EndAppend();
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -59,6 +95,20 @@ class TableHeap {
    */
   void ApplyDelete(const RowId &rid, Transaction *txn);
 
+  /**
+   * Apply the deletes of all tuples marked deleted: compact every page, and unlink and delete the pages that empty,
+   * except for the first one. Pages taken out of the heap earlier while someone had them pinned are deleted now.
+   * Must not run while a delete that may still be rolled back is pending.
+   * @return what the run found and gave back
+   */
+  VacuumStats Vacuum();
+
+  /**
+   * @return whether the heap holds at least one tuple marked deleted per page, so that a Vacuum walking it costs no
+   *         more than a page visit per removed tuple
+   */
+  bool NeedsVacuum();
+
   /**
    * Called on abort to rollback a delete.
    * @param[in] rid Rid of the deleted tuple.
@@ -70,20 +120,30 @@ class TableHeap {
    * Read a tuple from the table.
    * @param[in/out] row Output variable for the tuple, row id of the tuple is wrapped in row
    * @param[in] txn transaction performing the read
+   * @param[in] strategy buffer access strategy to read the page through, null for the shared pool
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(Row *row, Transaction *txn);
+  bool GetTuple(Row *row, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   void FreeTableHeap() {
+    EndAppend();
+    DestroyFreeSpaceMap();
+    DeleteRemovedPages();
     auto next_page_id = first_page_id_;
+    size_t pages_freed = 0;
     while (next_page_id != INVALID_PAGE_ID) {
       auto old_page_id = next_page_id;
       auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
       assert(page != nullptr);
       next_page_id = page->GetNextPageId();
+      // keep the pages ahead on their way in while the ones already cached are freed
+      if (pages_freed++ % (DEFAULT_READ_AHEAD_PAGES / 2) == 0) {
+        buffer_pool_manager_->ReadAhead(next_page_id, DEFAULT_READ_AHEAD_PAGES, NextPageId);
+      }
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
     }
+    buffer_pool_manager_->ReleaseAllocationRun(&run_);
   }
 
   /**
@@ -92,9 +152,11 @@ class TableHeap {
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
   /**
+   * @param strategy buffer access strategy the iterator reads pages through, e.g. a scan ring; null for the shared
+   *        pool. It must outlive the iterator.
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * @return the end iterator of this table
@@ -106,7 +168,46 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the share of the links of the heap's page chain that do not lead to the next page of the file: 0 for a
+   *         heap that is laid out sequentially, close to 1 for one that is scattered across the file
+   */
+  double GetFragmentation();
+
+  /**
+   * Turn page compression of the heap on or off. The heap marks the pages it creates or changes, and the buffer pool
+   * stores marked pages compressed when it writes them back, see DiskManager::WritePage. Switching marks every page
+   * of the heap dirty, so that existing pages are rewritten in the new mode.
+   */
+  void SetCompression(bool compressed);
+
+  /** @return whether the heap's pages are stored compressed */
+  inline bool IsCompressed() const { return compressed_; }
+
 private:
+  /**
+   * @return the heap's free space map, opening it or building it from the page chain on first use; null if that
+   *         failed because the buffer pool had no frame to spare, the next call tries again
+   */
+  FreeSpaceMap *GetFreeSpaceMap();
+
+  /** Delete the pages of the heap's free space map. The first page must still exist. */
+  void DestroyFreeSpaceMap();
+
+  /**
+   * Take an empty page other than the first one out of the heap: unlink it from the page chain, drop it from the free
+   * space map and delete it. The caller must not keep it pinned; a page someone else still has pinned, e.g. a scan
+   * that has not moved on yet, is deleted by the next Vacuum.
+   * @return false if a neighbour could not be fetched or the map could not drop the page, which then stays in the heap
+   */
+  bool RemovePage(page_id_t page_id, page_id_t prev_page_id, page_id_t next_page_id);
+
+  /** Delete the pages RemovePage took out of the heap but could not delete yet, as far as they are unpinned by now. */
+  void DeleteRemovedPages();
+
+  /** @return the id of the page after a table page in the heap's page chain, for BufferPoolManager::ReadAhead */
+  static page_id_t NextPageId(Page *page) { return reinterpret_cast<TablePage *>(page)->GetNextPageId(); }
+
   /**
    * create table heap and initialize first page
    */
@@ -118,18 +219,27 @@ private:
           lock_manager_(lock_manager) 
 	{
     //ASSERT(false, "Not implemented yet.");
-		TablePage* page = reinterpret_cast<TablePage*>(buffer_pool_manager->NewPage(first_page_id_));
+		TablePage* page = reinterpret_cast<TablePage*>(buffer_pool_manager->NewPage(first_page_id_, &run_));
 		page->Init(first_page_id_, -1, log_manager, txn); // -1 == Invalid_PAGE_Id
 		buffer_pool_manager->UnpinPage(first_page_id_, true);
 	};
 
+  /**
+   * open an existing table heap, which is compressed if its first page was stored compressed
+   */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
                      LogManager *log_manager, LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+        lock_manager_(lock_manager) {
+    Page *page = buffer_pool_manager_->FetchPage(first_page_id_);
+    if (page != nullptr) {
+      compressed_ = page->IsCompressed();
+      buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    }
+  }
 
  private:
   BufferPoolManager *buffer_pool_manager_;
@@ -137,6 +247,13 @@ private:
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  AllocationRun run_;  // contiguous pages reserved for the heap's next pages
+  bool compressed_{false};
+  std::unique_ptr<FreeSpaceMap> free_space_map_;  // null until first used
+  TablePage *append_page_{nullptr};  // last page, pinned while an append is in progress
+  bool append_page_dirty_{false};
+  size_t dead_tuples_{0};  // tuples marked deleted since the last vacuum, as far as this instance saw
+  std::vector<page_id_t> removed_page_ids_;  // pages out of the heap that were still pinned when they were removed
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -3,17 +3,35 @@
 
 #include "common/rowid.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/transaction.h"
 
 class TableHeap;
 
+class TablePage;
+
+class BufferAccessStrategy;
+
+/**
+ * Iterates over the tuples of a table heap in page chain order. The iterator keeps the page of its current tuple
+ * pinned and reads the following tuples of that page from the pinned frame, so that a scan fetches every page once
+ * instead of twice per tuple; the pin moves on with the iterator and is dropped at the end of the heap. Copies pin the
+ * page again. The page is only latched while a tuple is read, changes of the page between tuples are seen.
+ *
+ * The Row of a tuple is only built when it is asked for, a scan that just tests the tuples can read them in place
+ * through GetRowView instead.
+ */
 class TableIterator {
+  friend class TableHeap;
+
 public:
   // you may define your own constructor based on your member variables
-  explicit TableIterator(TableHeap* th, Row row, Transaction* txn);
+  explicit TableIterator(TableHeap* th, Row row, Transaction* txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other);
 
+  TableIterator(TableIterator &&other) noexcept;
+
   TableIterator(){};
   
 	//explicit TableIterator(TableIterator &other);
@@ -30,17 +48,38 @@ public:
 
   TableIterator &operator=(const TableIterator &itr) noexcept;
 
+  TableIterator &operator=(TableIterator &&itr) noexcept;
+
   TableIterator &operator++();
 
   TableIterator operator++(int);
 
   Row *GetRow();
 
+  /**
+   * @return a view of the current tuple's bytes in the pinned page, to read fields without building the Row. It is
+   *         valid until the iterator moves on; the page is not latched while the view is read.
+   */
+  RowView GetRowView();
+
 private:
+  /** Start at the tuple rid of page, which the caller has pinned and hands over; page is null for the end. */
+  TableIterator(TableHeap *th, TablePage *page, const RowId &rid, Transaction *txn, BufferAccessStrategy *strategy);
+
+  /** Read the tuple of row_'s rid from the pinned page, unless it was read already. */
+  void ReadRow();
+
+  /** Unpin the current page, if any. */
+  void ReleasePage();
+
   // add your own private member variables here
 	TableHeap *th_;
 	Row row_;
 	Transaction* txn_;
+	BufferAccessStrategy *strategy_{nullptr};  // how pages are brought into the buffer pool, may be null
+	TablePage *page_{nullptr};  // the pinned page of the current tuple, null at the end
+	bool row_read_{false};  // whether row_ holds the fields of the current tuple or just its rid
+	size_t pages_entered_{0};  // pages moved on to so far, paces the read-ahead of the heap chain
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
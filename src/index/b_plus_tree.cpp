@@ -16,7 +16,14 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
       processor_(KM),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) 
-{  //get Page 1(it contains data about all index)
+{
+	// by default a node holds as many pairs as fit into a page, less one slot for the pair that makes it split
+	if(leaf_max_size_ == UNDEFINED_SIZE)
+		leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(RowId)) - 1;
+	if(internal_max_size_ == UNDEFINED_SIZE)
+		internal_max_size_ = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(page_id_t)) - 1;
+
+	//get Page 1(it contains data about all index)
 	auto index_root_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
 	auto irp_data = reinterpret_cast<IndexRootsPage*>(index_root_page->GetData());
 	
@@ -63,6 +70,7 @@ void BPlusTree::Destroy() {
 	
 		buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
 	}
+	buffer_pool_manager_->ReleaseAllocationRun(&run_);
 }
 
 /*
@@ -128,7 +136,7 @@ bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transac
  * tree's root page id and insert entry directly into leaf page.
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
-	auto page = buffer_pool_manager_->NewPage(root_page_id_);
+	auto page = buffer_pool_manager_->NewPage(root_page_id_, &run_);
 	if(nullptr == page)
 	{
 		cout << "oom in BPT::StartNewTree" << endl;
@@ -219,7 +227,7 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
 // split will new a page (which will pin it)
 page_id_t BPlusTree::Split(InternalPage *node, Transaction *transaction) {
 	page_id_t page_id;
-	auto page = buffer_pool_manager_->NewPage(page_id); 
+	auto page = buffer_pool_manager_->NewPage(page_id, &run_);
 	if(nullptr == page)
 	{
 		cout << "oom in BPT::Split" << endl;
@@ -238,7 +246,7 @@ page_id_t BPlusTree::Split(InternalPage *node, Transaction *transaction) {
 
 page_id_t BPlusTree::Split(LeafPage *node, Transaction *transaction) {
 	page_id_t page_id;
-	auto page = buffer_pool_manager_->NewPage(page_id); 
+	auto page = buffer_pool_manager_->NewPage(page_id, &run_);
 	if(nullptr == page)
 	{
 		cout << "oom in BPT::Split" << endl;
@@ -269,7 +277,7 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
 	static int count_ = 0;
 	count_++;
 	if (old_node->IsRootPage()) {
-    auto page = buffer_pool_manager_->NewPage(root_page_id_);
+    auto page = buffer_pool_manager_->NewPage(root_page_id_, &run_);
     if (page == nullptr) {
 			cout << "oom in BPT::InsertIntoParent" << endl;
 			buffer_pool_manager_->UnpinPage(root_page_id_, false);
@@ -1,5 +1,7 @@
 #include "page/bitmap_page.h"
 
+#include <cstring>
+
 #include "glog/logging.h"
 
 /**
@@ -19,13 +21,52 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
 	if(page_allocated_ == MAX_CHARS * 8)
 		return true; //no free page
 
-	uint32_t free_index = 0;
+	next_free_page_ = FindFreePage();
+	return true;
+}
 
-	while(free_index < MAX_CHARS * 8 && !IsPageFree(free_index))
-		free_index++;
+template <size_t PageSize>
+bool BitmapPage<PageSize>::AllocateRun(uint32_t run_size, uint32_t &page_offset) {
+	ASSERT(run_size > 0 && run_size % 8 == 0, "Run size must be a multiple of 8.");
+	uint32_t run_bytes = run_size / 8;
+	if(page_allocated_ + run_size > MAX_CHARS * 8)
+		return false;
 
-	next_free_page_ = free_index;
-	return true;
+	for(uint32_t byte_index = 0; byte_index + run_bytes <= MAX_CHARS; byte_index += run_bytes) {
+		uint32_t i = 0;
+		while(i < run_bytes && bytes[byte_index + i] == 0)
+			i++;
+		if(i < run_bytes)
+			continue;
+
+		memset(bytes + byte_index, 0xFF, run_bytes);
+		page_allocated_ += run_size;
+		page_offset = byte_index * 8;
+		//the next free page may have been part of the run
+		if(page_allocated_ < MAX_CHARS * 8 && !IsPageFree(next_free_page_))
+			next_free_page_ = FindFreePage();
+		return true;
+	}
+	return false;
+}
+
+template <size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindFreePage() const {
+	//skip fully allocated bytes a word at a time
+	uint32_t byte_index = 0;
+	uint64_t word;
+	while(byte_index + sizeof(word) <= MAX_CHARS) {
+		memcpy(&word, bytes + byte_index, sizeof(word));
+		if(word != UINT64_MAX)
+			break;
+		byte_index += sizeof(word);
+	}
+	while(bytes[byte_index] == 0xFF)
+		byte_index++;
+	uint8_t bit_index = 0;
+	while(!IsPageFreeLow(byte_index, bit_index))
+		bit_index++;
+	return byte_index * 8 + bit_index;
 }
 
 /**
@@ -69,3 +110,9 @@ template class BitmapPage<1024>;
 template class BitmapPage<2048>;
 
 template class BitmapPage<4096>;
+
+template class BitmapPage<8192>;
+
+template class BitmapPage<16384>;
+
+template class BitmapPage<32768>;
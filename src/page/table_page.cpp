@@ -1,45 +1,61 @@
 #include "page/table_page.h"
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn) {
   memcpy(GetData(), &page_id, sizeof(page_id));
   SetPrevPageId(prev_id);
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(PAGE_SIZE);
+  SetFreeSlotList(FREE_SLOT_LIST_FLAG);
   SetTupleCount(0);
+  SetFragmentedBytes(0);
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+  LinkFreeSlots();
+  // Reuse a free slot if there is one, otherwise the tuple needs a new slot at the end of the slot array.
+  uint32_t i = GetFirstFreeSlot();
+  uint32_t slot_size = 0;
+  if (i == NO_SLOT) {
+    i = GetTupleCount();
+    slot_size = SIZE_TUPLE;
+  }
+  if (GetFreeSpaceRemaining() < serialized_size + slot_size) {
     return false;
   }
-  // Try to find a free slot to reuse.
-  uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
-      // Then we break out of the loop at index i.
-      break;
+  uint32_t tuple_offset;
+  if (slot_size == 0 && GetHoleSize(i) >= serialized_size) {
+    // The tuple fits into the hole the slot's last tuple left, the rest of it stays a hole.
+    tuple_offset = GetHoleOffset(i) + GetHoleSize(i) - serialized_size;
+    SetFragmentedBytes(GetFragmentedBytes() - serialized_size);
+  } else {
+    // Otherwise we claim available free space, joining the holes with it first if necessary.
+    if (GetContiguousFreeSpace() < serialized_size + slot_size) {
+      Compact();
     }
+    SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
+    tuple_offset = GetFreeSpacePointer();
   }
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
+  if (slot_size == 0) {
+    UnlinkFreeSlot(i);
+  } else {
+    SetTupleCount(GetTupleCount() + 1);
   }
-  // Otherwise we claim available free space..
-  SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
-  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
+  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + tuple_offset, schema);
   ASSERT(write_bytes == serialized_size, "Unexpected behavior in row serialize.");
 
   // Set the tuple.
-  SetTupleOffsetAtSlot(i, GetFreeSpacePointer());
+  SetTupleOffsetAtSlot(i, tuple_offset);
   SetTupleSize(i, serialized_size);
   // Set rid
   row.SetRowId(RowId(GetTablePageId(), i));
-  if (i == GetTupleCount()) {
-    SetTupleCount(GetTupleCount() + 1);
-  }
   return true;
 }
 
@@ -87,21 +103,28 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Tr
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
-  memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-  new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
-  SetTupleSize(slot_num, serialized_size);
-
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+  if (serialized_size <= tuple_size) {
+    // The new tuple takes the end of the old one, what is left of it becomes a hole.
+    uint32_t new_tuple_offset = tuple_offset + tuple_size - serialized_size;
+    new_row.SerializeTo(GetData() + new_tuple_offset, schema);
+    if (tuple_offset == GetFreeSpacePointer()) {
+      SetFreeSpacePointer(new_tuple_offset);
+    } else {
+      SetFragmentedBytes(GetFragmentedBytes() + tuple_size - serialized_size);
+    }
+    SetTupleOffsetAtSlot(slot_num, new_tuple_offset);
+  } else {
+    // The old tuple becomes a hole and the new one goes to the free space, joined with the holes if necessary.
+    SetTupleSize(slot_num, 0);
+    SetFragmentedBytes(GetFragmentedBytes() + tuple_size);
+    if (GetContiguousFreeSpace() < serialized_size) {
+      Compact();
     }
+    SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
+    new_row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
+    SetTupleOffsetAtSlot(slot_num, GetFreeSpacePointer());
   }
+  SetTupleSize(slot_num, serialized_size);
 	state = 0;
   return true;
 }
@@ -109,32 +132,123 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Tr
 void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+  LinkFreeSlots();
 
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t tuple_size = GetTupleSize(slot_num);
+  // The slot may be free already.
+  if (IsFree(tuple_size)) {
+    return;
+  }
   // Check if this is a delete operation, i.e. commit a delete.
   if (IsDeleted(tuple_size)) {
     tuple_size = UnsetDeletedFlag(tuple_size);
   }
 
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
+  // Leave the tuple's bytes as a hole, unless they border the free space.
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  ASSERT(tuple_offset >= GetFreeSpacePointer(), "Free space appears before tuples.");
+  if (tuple_offset == GetFreeSpacePointer()) {
+    SetFreeSpacePointer(tuple_offset + tuple_size);
+    SetFreeSlotHole(slot_num, 0, 0);
+  } else {
+    SetFragmentedBytes(GetFragmentedBytes() + tuple_size);
+    SetFreeSlotHole(slot_num, tuple_offset, tuple_size);
+  }
+  PushFreeSlot(slot_num);
+  TrimEmptySlots();
+}
 
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
-  SetTupleSize(slot_num, 0);
-  SetTupleOffsetAtSlot(slot_num, 0);
+uint32_t TablePage::Vacuum() {
+  LinkFreeSlots();
+  uint32_t removed = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (!IsFree(tuple_size) && IsDeleted(tuple_size)) {
+      SetFragmentedBytes(GetFragmentedBytes() + UnsetDeletedFlag(tuple_size));
+      SetFreeSlotHole(i, 0, 0);
+      PushFreeSlot(i);
+      removed++;
+    }
+  }
+  if (removed > 0) {
+    TrimEmptySlots();
+    Compact();
+  }
+  return removed;
+}
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
+void TablePage::LinkFreeSlots() {
+  if ((GetFreeSlotList() & FREE_SLOT_LIST_FLAG) != 0) {
+    return;
+  }
+  SetFirstFreeSlot(NO_SLOT);
+  for (uint32_t i = GetTupleCount(); i-- > 0;) {
+    if (IsFree(GetTupleSize(i))) {
+      SetFreeSlotHole(i, 0, 0);
+      PushFreeSlot(i);
     }
   }
 }
 
+void TablePage::PushFreeSlot(uint32_t slot_num) {
+  uint32_t next_slot_num = GetFirstFreeSlot();
+  SetFreeSlotLinks(slot_num, next_slot_num, NO_SLOT);
+  if (next_slot_num != NO_SLOT) {
+    SetFreeSlotLinks(next_slot_num, GetNextFreeSlot(next_slot_num), slot_num);
+  }
+  SetFirstFreeSlot(slot_num);
+}
+
+void TablePage::UnlinkFreeSlot(uint32_t slot_num) {
+  uint32_t next_slot_num = GetNextFreeSlot(slot_num);
+  uint32_t prev_slot_num = GetPrevFreeSlot(slot_num);
+  if (prev_slot_num != NO_SLOT) {
+    SetFreeSlotLinks(prev_slot_num, next_slot_num, GetPrevFreeSlot(prev_slot_num));
+  } else {
+    SetFirstFreeSlot(next_slot_num);
+  }
+  if (next_slot_num != NO_SLOT) {
+    SetFreeSlotLinks(next_slot_num, GetNextFreeSlot(next_slot_num), prev_slot_num);
+  }
+}
+
+void TablePage::TrimEmptySlots() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && IsFree(GetTupleSize(tuple_count - 1))) {
+    UnlinkFreeSlot(--tuple_count);
+  }
+  SetTupleCount(tuple_count);
+  // An empty page has no holes left either.
+  if (tuple_count == 0) {
+    SetFreeSpacePointer(PAGE_SIZE);
+    SetFragmentedBytes(0);
+  }
+}
+
+void TablePage::Compact() {
+  std::vector<std::pair<uint32_t, uint32_t>> tuples;  // (offset, slot) of each tuple, deleted or not
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (IsFree(GetTupleSize(i))) {
+      SetFreeSlotHole(i, 0, 0);
+    } else {
+      tuples.emplace_back(GetTupleOffsetAtSlot(i), i);
+    }
+  }
+  // Move the tuples towards the end of the page, the one nearest to it first, so that none is overwritten.
+  std::sort(tuples.begin(), tuples.end(), std::greater<>());
+  uint32_t free_space_pointer = PAGE_SIZE;
+  for (auto &[tuple_offset, slot_num] : tuples) {
+    uint32_t tuple_size = UnsetDeletedFlag(GetTupleSize(slot_num));
+    free_space_pointer -= tuple_size;
+    if (free_space_pointer != tuple_offset) {
+      memmove(GetData() + free_space_pointer, GetData() + tuple_offset, tuple_size);
+      SetTupleOffsetAtSlot(slot_num, free_space_pointer);
+    }
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetFragmentedBytes(0);
+}
+
 void TablePage::RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
@@ -167,6 +281,14 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   return true;
 }
 
+const char *TablePage::GetTupleData(const RowId &rid) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+    return nullptr;
+  }
+  return GetData() + GetTupleOffsetAtSlot(slot_num);
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
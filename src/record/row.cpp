@@ -6,60 +6,79 @@
 uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
-  // replace with your code here
-	// schema useless??
-
-	uint32_t fs = fields_.size(), offset = 0;
+	uint32_t fs = fields_.size();
 	if(fs == 0)
 		return 0;
-	
-	MACH_WRITE_UINT32(buf, fs);  //write field num into buf
-	buf += 4;
-	offset += 4;
 
-	char bits = 0;
-	uint32_t map[fs];
-	for(int i = 0;i < fs; i++)
+	MACH_WRITE_TO(uint16_t, buf, ROW_FORMAT_V2);
+	char *bitmap = buf + sizeof(uint16_t);
+	char *fixed = bitmap + GetNullBitmapSize(fs);
+	char *offsets = fixed + schema->GetFixedSize();
+	uint32_t end = offsets - buf + schema->GetVarColumnCount() * sizeof(uint16_t);
+	memset(bitmap, 0, fixed - bitmap);
+
+	for(uint32_t i = 0; i < fs; i++)
 	{
-		if(!fields_[i]->IsNull())
+		const Field *field = fields_[i];
+		if(!field->IsNull())
+			bitmap[i / 8] |= 0x80 >> (i % 8);
+		uint32_t slot = schema->GetRowLayout(i);
+		if(schema->GetColumn(i)->GetType() != TypeId::kTypeChar)
 		{
-			bits |= 0x80 >> (i%8);
-			map[i] = 1;
+			//a null value keeps its place in the fixed area
+			if(field->IsNull())
+				memset(fixed + slot, 0, Type::GetTypeSize(schema->GetColumn(i)->GetType()));
+			else
+				field->SerializeTo(fixed + slot);
+			continue;
 		}
-		else
-			map[i] = 0;
-
-		if(i%8 == 7)   //write into buf per Byte
+		if(!field->IsNull())
 		{
-			MACH_WRITE_TO(char, buf, bits);  //write bits into buf
-			bits = 0;
-			buf += 1;
-			offset += 1;
+			memcpy(buf + end, field->GetData(), field->GetLength());
+			end += field->GetLength();
 		}
+		MACH_WRITE_TO(uint16_t, offsets + slot * sizeof(uint16_t), end);
 	}
-	
-	if((fs % 8) != 0)
-	{
-		MACH_WRITE_TO(char, buf, bits);  //write bits into buf
-		bits = 0;
-		buf += 1;
-		offset += 1;
-	}
+  return end;
+}
 
-	for(int i = 0;i < fs;i++)
+uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
+  ASSERT(schema != nullptr, "Invalid schema before serialize.");
+	if(MACH_READ_FROM(uint16_t, buf) != ROW_FORMAT_V2)
+		return DeserializeFromV1(buf, schema);
+
+	uint32_t fs = schema->GetColumnCount();
+	const char *bitmap = buf + sizeof(uint16_t);
+	char *fixed = buf + sizeof(uint16_t) + GetNullBitmapSize(fs);
+	char *offsets = fixed + schema->GetFixedSize();
+	uint32_t end = offsets - buf + schema->GetVarColumnCount() * sizeof(uint16_t);
+
+	for(uint32_t i = 0; i < fs; i++)
 	{
-		if(map[i])
+		TypeId type = schema->GetColumn(i)->GetType();
+		bool is_null = (bitmap[i / 8] & (0x80 >> (i % 8))) == 0;
+		uint32_t slot = schema->GetRowLayout(i);
+		Field *field;
+		if(type != TypeId::kTypeChar)
 		{
-			uint32_t offset_ = fields_[i]->SerializeTo(buf);
-			buf += offset_;
-			offset += offset_;
+			Type::GetInstance(type)->DeserializeFrom(fixed + slot, &field, is_null, col_heap_);
+		}
+		else
+		{
+			//a CHAR value starts where the one before it ended
+			uint32_t start = end;
+			end = MACH_READ_FROM(uint16_t, offsets + slot * sizeof(uint16_t));
+			if(is_null)
+				field = ALLOC_P(col_heap_, Field)(type);
+			else
+				field = NewCharField(buf + start, end - start);
 		}
+		fields_.push_back(field);
 	}
-
-  return offset;
+  return end;
 }
 
-uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
+uint32_t Row::DeserializeFromV1(char *buf, Schema *schema) {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   //ASSERT(fields_.empty(), "Non empty field in row.");
   // replace with your code here
@@ -132,20 +151,15 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
 uint32_t Row::GetSerializedSize(Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
-  // replace with your code here
 	if(fields_.size() == 0)
 		return 0;
-	
-	uint32_t ss = 0;
-	ss += 4;  //field num
-	ss += (uint32_t)ceil((double)fields_.size() / 8);  // bit/8
 
-	for(int i = 0;i < fields_.size();i++)
+	uint32_t ss = sizeof(uint16_t) + GetNullBitmapSize(fields_.size()) + schema->GetFixedSize() +
+	              schema->GetVarColumnCount() * sizeof(uint16_t);
+	for(uint32_t i = 0; i < fields_.size(); i++)
 	{
-		if(!fields_[i]->IsNull())
-		{
-			ss += fields_[i]->GetSerializedSize();
-		}
+		if(schema->GetColumn(i)->GetType() == TypeId::kTypeChar && !fields_[i]->IsNull())
+			ss += fields_[i]->GetLength();
 	}
   return ss;
 }
@@ -160,3 +174,30 @@ void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key
   }
   key_row = Row(fields);
 }
+
+Field *Row::CopyField(const Field &field) {
+	if(field.GetTypeId() == TypeId::kTypeChar && !field.IsNull())
+		return NewCharField(field.GetData(), field.GetLength());
+	return ALLOC_P(col_heap_, Field)(field);
+}
+
+Field *Row::NewCharField(const char *data, uint32_t len) {
+	//short characters are kept in the field, others live in the heap too, so the field needs no destructor
+	if(len <= Field::INLINE_CHARS_SIZE)
+		return ALLOC_P(col_heap_, Field)(TypeId::kTypeChar, const_cast<char *>(data), len, true);
+	char *chars = static_cast<char *>(col_heap_->Allocate(len));
+	memcpy(chars, data, len);
+	return ALLOC_P(col_heap_, Field)(TypeId::kTypeChar, chars, len, false);
+}
+
+void Row::CopyFields(const Row &other) {
+	fields_.reserve(other.fields_.size());
+	for(auto field : other.fields_)
+		fields_.push_back(CopyField(*field));
+}
+
+void Row::ClearFields() {
+	fields_.clear();
+	if(col_heap_ == &own_heap_)
+		own_heap_.Reset();
+}
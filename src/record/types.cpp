@@ -233,7 +233,7 @@ uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
   if (!field.IsNull()) {
     uint32_t len = GetLength(field);
     memcpy(buf, &len, sizeof(uint32_t));
-    memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
+    memcpy(buf + sizeof(uint32_t), field.GetChars(), len);
     return len + sizeof(uint32_t);
   }
   return 0;
@@ -247,7 +247,10 @@ uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null, M
   }
   uint32_t len = MACH_READ_UINT32(storage);
   //*field = new Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
-  *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  //the characters are copied into the heap with the field, which is never destructed
+  char *chars = static_cast<char *>(heap->Allocate(len));
+  memcpy(chars, storage + sizeof(uint32_t), len);
+  *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, chars, len, false);
 	return len + sizeof(uint32_t);
 }
 
@@ -260,7 +263,7 @@ uint32_t TypeChar::GetSerializedSize(const Field &field, bool is_null) const {
 }
 
 const char *TypeChar::GetData(const Field &val) const {
-  return val.value_.chars_;
+  return val.GetChars();
 }
 
 uint32_t TypeChar::GetLength(const Field &val) const {
@@ -0,0 +1,311 @@
+#include "storage/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define MINISQL_HAVE_IO_URING
+#endif
+
+#include "glog/logging.h"
+#include "storage/disk_manager.h"
+
+// the thread pool backend never runs more I/O threads than this
+static constexpr size_t MAX_IO_THREADS = 8;
+
+AsyncIO::AsyncIO(DiskManager *disk_manager, size_t queue_depth)
+    : disk_manager_(disk_manager), queue_depth_(std::max<size_t>(1, queue_depth)) {}
+
+int AsyncIO::GetFd() const {
+  return disk_manager_->fd_;
+}
+
+size_t AsyncIO::GetPageOffset(page_id_t page_id) const {
+  return static_cast<size_t>(disk_manager_->MapPageId(page_id)) * PAGE_SIZE;
+}
+
+void AsyncIO::FinishRequest(AsyncIORequest *request, ssize_t done) {
+  request->result_ = disk_manager_->TransferPage(request->is_write_, GetPageOffset(request->page_id_), request->data_,
+                                                 std::max<ssize_t>(done, 0));
+  if (request->result_ != 0) {
+    LOG(ERROR) << "I/O error on page " << request->page_id_ << ": " << strerror(-request->result_);
+  } else if (!request->is_write_) {
+    request->compressed_ = disk_manager_->DecompressPage(request->data_);
+  }
+}
+
+/**
+ * Thread pool backend: the requests are queued for up to MAX_IO_THREADS threads that do blocking pread/pwrite.
+ */
+class ThreadPoolAsyncIO : public AsyncIO {
+ public:
+  ThreadPoolAsyncIO(DiskManager *disk_manager, size_t queue_depth) : AsyncIO(disk_manager, queue_depth) {
+    size_t num_threads = std::min(queue_depth_, MAX_IO_THREADS);
+    for (size_t i = 0; i < num_threads; i++) {
+      threads_.emplace_back(&ThreadPoolAsyncIO::Run, this);
+    }
+  }
+
+  ~ThreadPoolAsyncIO() override {
+    {
+      std::scoped_lock<std::mutex> lock(latch_);
+      stop_ = true;
+    }
+    submitted_cv_.notify_all();
+    // the threads drain the queue before they exit
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  size_t Submit(AsyncIORequest *const *requests, size_t count) override {
+    count = std::min(count, queue_depth_ - in_flight_);
+    if (count == 0) {
+      return 0;
+    }
+    {
+      std::scoped_lock<std::mutex> lock(latch_);
+      submitted_.insert(submitted_.end(), requests, requests + count);
+    }
+    in_flight_ += count;
+    submitted_cv_.notify_all();
+    return count;
+  }
+
+  size_t Reap(AsyncIORequest **completed, size_t max_count, size_t min_count) override {
+    min_count = std::min(min_count, in_flight_);
+    std::unique_lock<std::mutex> lock(latch_);
+    completed_cv_.wait(lock, [this, min_count] { return completed_.size() >= min_count; });
+    size_t count = std::min(max_count, completed_.size());
+    std::copy(completed_.begin(), completed_.begin() + count, completed);
+    completed_.erase(completed_.begin(), completed_.begin() + count);
+    in_flight_ -= count;
+    return count;
+  }
+
+  AsyncIOType GetType() const override { return AsyncIOType::THREAD_POOL; }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (true) {
+      submitted_cv_.wait(lock, [this] { return stop_ || !submitted_.empty(); });
+      if (submitted_.empty()) {
+        break;
+      }
+      AsyncIORequest *request = submitted_.front();
+      submitted_.pop_front();
+      lock.unlock();
+      FinishRequest(request, 0);
+      lock.lock();
+      completed_.push_back(request);
+      completed_cv_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::deque<AsyncIORequest *> submitted_;  // waiting for an I/O thread, protected by latch_
+  std::deque<AsyncIORequest *> completed_;  // waiting to be reaped, protected by latch_
+  bool stop_{false};
+  std::mutex latch_;
+  std::condition_variable submitted_cv_;
+  std::condition_variable completed_cv_;
+};
+
+#ifdef MINISQL_HAVE_IO_URING
+/**
+ * io_uring backend, driven through the raw system calls so that no liburing is needed. Submit fills the submission
+ * queue and enters the kernel once per batch, Reap collects completion queue entries and only enters the kernel to
+ * wait when not enough of them are there yet.
+ */
+class IOUringAsyncIO : public AsyncIO {
+ public:
+  IOUringAsyncIO(DiskManager *disk_manager, size_t queue_depth) : AsyncIO(disk_manager, queue_depth) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth_), &params));
+    if (ring_fd_ < 0) {
+      return;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(Map(sqes_size_, IORING_OFF_SQES));
+    if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+      return;
+    }
+    sq_tail_ = RingField(sq_ring_, params.sq_off.tail);
+    sq_mask_ = *RingField(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = RingField(sq_ring_, params.sq_off.array);
+    cq_head_ = RingField(cq_ring_, params.cq_off.head);
+    cq_tail_ = RingField(cq_ring_, params.cq_off.tail);
+    cq_mask_ = *RingField(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(cq_ring_) + params.cq_off.cqes);
+    ready_ = true;
+  }
+
+  ~IOUringAsyncIO() override {
+    if (ready_) {
+      // the kernel may still write into the requests' pages
+      AsyncIORequest *completed[16];
+      while (in_flight_ > 0 && Reap(completed, 16, 1) > 0) {
+      }
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+
+  /** @return whether the ring was set up */
+  bool IsReady() const { return ready_; }
+
+  size_t Submit(AsyncIORequest *const *requests, size_t count) override {
+    count = std::min(count, queue_depth_ - in_flight_);
+    unsigned tail = *sq_tail_;
+    for (size_t i = 0; i < count; i++) {
+      AsyncIORequest *request = requests[i];
+      unsigned index = tail & sq_mask_;
+      io_uring_sqe *sqe = sqes_ + index;
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = request->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = GetFd();
+      sqe->addr = reinterpret_cast<uint64_t>(request->data_);
+      sqe->len = PAGE_SIZE;
+      sqe->off = GetPageOffset(request->page_id_);
+      sqe->user_data = reinterpret_cast<uint64_t>(request);
+      sq_array_[index] = index;
+      tail++;
+    }
+    // publish the entries before the kernel can see the new tail
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    in_flight_ += count;
+    unsubmitted_ += count;
+    Enter(0);
+    return count;
+  }
+
+  size_t Reap(AsyncIORequest **completed, size_t max_count, size_t min_count) override {
+    min_count = std::min(min_count, in_flight_);
+    size_t count = 0;
+    while (true) {
+      unsigned head = *cq_head_;
+      unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      while (head != tail && count < max_count) {
+        io_uring_cqe *cqe = cqes_ + (head & cq_mask_);
+        auto *request = reinterpret_cast<AsyncIORequest *>(cqe->user_data);
+        FinishRequest(request, cqe->res);
+        completed[count++] = request;
+        head++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (count >= min_count || count == max_count) {
+        break;
+      }
+      if (!Enter(min_count - count)) {
+        break;
+      }
+    }
+    in_flight_ -= count;
+    return count;
+  }
+
+  AsyncIOType GetType() const override { return AsyncIOType::IO_URING; }
+
+ private:
+  void *Map(size_t size, off_t offset) {
+    void *ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ring == MAP_FAILED ? nullptr : ring;
+  }
+
+  static unsigned *RingField(void *ring, uint32_t offset) {
+    return reinterpret_cast<unsigned *>(static_cast<char *>(ring) + offset);
+  }
+
+  /**
+   * Hand the submission queue entries the kernel did not take yet to it, and wait for min_complete completions.
+   * @return false if the kernel refused
+   */
+  bool Enter(size_t min_complete) {
+    unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (unsubmitted_ == 0 && flags == 0) {
+      return true;
+    }
+    while (true) {
+      long ret = syscall(__NR_io_uring_enter, ring_fd_, static_cast<unsigned>(unsubmitted_),
+                         static_cast<unsigned>(min_complete), flags, nullptr, 0);
+      if (ret >= 0) {
+        unsubmitted_ -= std::min<size_t>(ret, unsubmitted_);
+        return true;
+      }
+      if (errno != EINTR) {
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+        return false;
+      }
+    }
+  }
+
+  int ring_fd_{-1};
+  bool ready_{false};
+  void *sq_ring_{nullptr};
+  void *cq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+  size_t unsubmitted_{0};  // entries in the submission queue the kernel has not consumed yet
+};
+#endif  // MINISQL_HAVE_IO_URING
+
+AsyncIO *AsyncIO::Create(DiskManager *disk_manager, size_t queue_depth, AsyncIOType type) {
+#ifdef MINISQL_HAVE_IO_URING
+  if (type != AsyncIOType::THREAD_POOL) {
+    auto *io = new IOUringAsyncIO(disk_manager, queue_depth);
+    if (io->IsReady()) {
+      return io;
+    }
+    delete io;
+    if (type == AsyncIOType::IO_URING) {
+      LOG(WARNING) << "io_uring is not available, using the thread pool for asynchronous I/O";
+    }
+  }
+#else
+  if (type == AsyncIOType::IO_URING) {
+    LOG(WARNING) << "io_uring is not supported, using the thread pool for asynchronous I/O";
+  }
+#endif
+  return new ThreadPoolAsyncIO(disk_manager, queue_depth);
+}
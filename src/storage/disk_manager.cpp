@@ -1,173 +1,519 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <linux/falloc.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
 #include <stdexcept>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
+#include "storage/page_compressor.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    std::filesystem::path p = db_file;
-    if(p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
+  // directory does not exist
+  std::filesystem::path p = db_file;
+  if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  if (direct_io) {
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = fd_ >= 0;
+    // e.g. tmpfs refuses O_DIRECT
+    if (fd_ < 0 && errno == EINVAL) {
+      LOG(WARNING) << "Direct I/O is not supported for " << db_file << ", using buffered I/O";
     }
   }
+  if (fd_ < 0) {
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (fd_ < 0) {
+    LOG(ERROR) << "Failed to open " << db_file << ": " << strerror(errno);
+    throw std::exception();
+  }
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) != 0) {
+    LOG(ERROR) << "Failed to stat " << db_file << ": " << strerror(errno);
+    close(fd_);
+    throw std::exception();
+  }
+  file_size_ = stat_buf.st_size;
+  block_size_ = std::clamp<size_t>(stat_buf.st_blksize, 512, PAGE_SIZE);
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  if (!LoadMetadata()) {
+    close(fd_);
+    throw std::exception();
+  }
+}
+
+bool DiskManager::LoadMetadata() {
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  if (meta_page->HasHeader()) {
+    if (meta_page->version_ != DiskFileMetaPage::VERSION || meta_page->page_id_size_ != sizeof(page_id_t)) {
+      LOG(ERROR) << file_name_ << " has meta page version " << meta_page->version_ << " with "
+                 << meta_page->page_id_size_ << " byte page ids, which this build does not support";
+      return false;
+    }
+    if (meta_page->page_size_ != PAGE_SIZE) {
+      LOG(ERROR) << file_name_ << " has " << meta_page->page_size_ << " byte pages, this build uses " << PAGE_SIZE
+                 << " byte pages";
+      return false;
+    }
+    for (page_id_t page_id = meta_page->next_page_id_; page_id != INVALID_PAGE_ID;) {
+      auto page = std::make_unique<MetaOverflowPage>();
+      ReadPage(page_id, page->data_);
+      page->page_id_ = page_id;
+      page_id = reinterpret_cast<DiskFileMetaOverflowPage *>(page->data_)->next_page_id_;
+      meta_overflow_pages_.push_back(std::move(page));
+    }
+    return true;
+  }
+  // a version 1 meta page, or the zeroed page of a new file: the counts move behind the header
+  if (file_size_ > 0 && PAGE_SIZE != DiskFileMetaPage::V1_PAGE_SIZE) {
+    LOG(ERROR) << file_name_ << " has " << DiskFileMetaPage::V1_PAGE_SIZE << " byte pages, this build uses "
+               << PAGE_SIZE << " byte pages";
+    return false;
+  }
+  const auto *v1_counts = reinterpret_cast<const uint32_t *>(meta_data_) + 2;
+  std::vector<uint32_t> counts(v1_counts, v1_counts + DiskFileMetaPage::V1_MAX_EXTENTS);
+  meta_page->magic_ = DiskFileMetaPage::MAGIC;
+  meta_page->version_ = DiskFileMetaPage::VERSION;
+  meta_page->page_id_size_ = sizeof(page_id_t);
+  meta_page->page_size_ = PAGE_SIZE;
+  meta_page->next_page_id_ = INVALID_PAGE_ID;
+  memset(meta_page->extent_used_page_, 0, DiskFileMetaPage::MAX_EXTENTS * sizeof(uint32_t));
+  meta_dirty_ = true;
+  // adding overflow pages allocates pages, which may count them in the extents that are converted later
+  for (uint32_t extent_id = 0; extent_id < counts.size(); extent_id++) {
+    if (counts[extent_id] != 0) {
+      *GetExtentUsedPageSlot(extent_id, true) += counts[extent_id];
+    }
+  }
+  return true;
 }
 
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    FlushMetadata();
+    close(fd_);
     closed = true;
   }
 }
 
-void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+bool DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  return DecompressPage(page_data);
 }
 
-void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
+void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data, bool compress) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  if (compress) {
+    WriteCompressedPage(MapPageId(logical_page_id), page_data);
+  } else {
+    WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  }
 }
 
 /**
  * TODO: Student Implement
  */
 page_id_t DiskManager::AllocatePage() {
-	DiskFileMetaPage* meta_ptr = reinterpret_cast<DiskFileMetaPage *>(meta_data_);  //cast the meta_data into MetaPage
-	uint32_t *eup = meta_ptr->extent_used_page_; 
-	
-	uint32_t extent_id = 0;
-	while(eup[extent_id] == BITMAP_SIZE){
-		extent_id++;
-	}
-	page_id_t bitmap_p_id = extent_id * (BITMAP_SIZE + 1) + 1; // +1 Disk Meta Page
-	
-	char bitmap[BITMAP_SIZE];
-	ReadPhysicalPage(bitmap_p_id,bitmap);
-	BitmapPage<PAGE_SIZE> *Bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap);
-
-	uint32_t free_page_id;
-	bool success = Bitmap->AllocatePage(free_page_id);
-	if(!success)
-	{
-		printf("error in DiskManger::AllocatePage\n");
-		exit(0);
-	}
-
-	//update  Because concurrency is not considered, metadata is modified directly
-	meta_ptr->num_allocated_pages_++;
-	meta_ptr->extent_used_page_[extent_id]++;
-
-	if(extent_id >= meta_ptr->num_extents_)
-		meta_ptr->num_extents_++;
-
-	//write
-	WritePhysicalPage(META_PAGE_ID, meta_data_);
-	WritePhysicalPage(bitmap_p_id, bitmap);
-	return free_page_id + extent_id * BITMAP_SIZE;
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  // extents below the hint are full, an extent that is not may still have all of its free pages reserved
+  uint32_t extent_id = first_free_extent_;
+  while (extent_id < MAX_EXTENTS && ExtentUsedPages(extent_id) == BITMAP_SIZE) {
+    extent_id++;
+  }
+  first_free_extent_ = extent_id;
+  uint32_t free_page_id;
+  while (extent_id < MAX_EXTENTS && !GetBitmap(extent_id)->AllocatePage(free_page_id)) {
+    extent_id++;
+  }
+  if (extent_id == MAX_EXTENTS) {
+    LOG(ERROR) << "No free page left in " << file_name_;
+    return INVALID_PAGE_ID;
+  }
+  CountAllocatedPage(extent_id);
+  return free_page_id + extent_id * BITMAP_SIZE;
 }
 
-/**
- * TODO: Student Implement
- */
-void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
-	DiskFileMetaPage* meta_ptr = reinterpret_cast<DiskFileMetaPage *>(meta_data_);  //cast the meta_data into MetaPage
-	page_id_t bitmap_p_id = (logical_page_id) / BITMAP_SIZE  * (BITMAP_SIZE + 1) + 1;
+page_id_t DiskManager::AllocatePage(AllocationRun *run) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (run->next_ == run->end_ && !ReserveRun(run)) {
+    return AllocatePage();
+  }
+  page_id_t page_id = run->next_++;
+  reserved_pages_.erase(page_id);
+  CountAllocatedPage(page_id / BITMAP_SIZE);
+  return page_id;
+}
+
+void DiskManager::ReleaseRun(AllocationRun *run) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  for (; run->next_ != run->end_; run->next_++) {
+    uint32_t extent_id = run->next_ / BITMAP_SIZE;
+    GetBitmap(extent_id)->DeAllocatePage(run->next_ % BITMAP_SIZE);
+    reserved_pages_.erase(run->next_);
+    first_free_extent_ = std::min(first_free_extent_, extent_id);
+  }
+  run->next_ = run->end_ = INVALID_PAGE_ID;
+}
 
-	char bitmap[BITMAP_SIZE];
-	ReadPhysicalPage(bitmap_p_id,bitmap);
-	BitmapPage<PAGE_SIZE> *Bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap);
-	
-	Bitmap->DeAllocatePage(logical_page_id % BITMAP_SIZE);
+void DiskManager::SetAllocationRunPages(uint32_t pages) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  allocation_run_pages_ = pages / 8 * 8;
+}
 
-	uint32_t extent_id = logical_page_id / BITMAP_SIZE;
-	//update  Because concurrency is not considered, metadata is modified directly
-	meta_ptr->num_allocated_pages_--;
-	meta_ptr->extent_used_page_[extent_id]--;
+bool DiskManager::ReserveRun(AllocationRun *run) {
+  if (allocation_run_pages_ == 0) {
+    return false;
+  }
+  for (uint32_t extent_id = first_free_extent_; extent_id < MAX_EXTENTS; extent_id++) {
+    uint32_t offset;
+    if (ExtentUsedPages(extent_id) + allocation_run_pages_ > BITMAP_SIZE ||
+        !GetBitmap(extent_id)->AllocateRun(allocation_run_pages_, offset)) {
+      continue;
+    }
+    // the run is only reserved in memory, FlushMetadata leaves the pages that were not handed out free on disk
+    run->next_ = extent_id * BITMAP_SIZE + offset;
+    run->end_ = run->next_ + allocation_run_pages_;
+    for (page_id_t page_id = run->next_; page_id != run->end_; page_id++) {
+      reserved_pages_.insert(page_id);
+    }
+    return true;
+  }
+  return false;
+}
 
-	if(meta_ptr->extent_used_page_[extent_id] == 0)
-		meta_ptr->num_extents_--;
+void DiskManager::CountAllocatedPage(uint32_t extent_id) {
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  bitmaps_[extent_id]->dirty_ = true;
+  meta_page->num_allocated_pages_++;
+  (*GetExtentUsedPageSlot(extent_id, true))++;
+  if (extent_id >= meta_page->num_extents_) {
+    meta_page->num_extents_++;
+  }
+  meta_dirty_ = true;
+}
 
-	//write
-	WritePhysicalPage(META_PAGE_ID, meta_data_);
-	WritePhysicalPage(bitmap_p_id, bitmap);
+/**
+ * TODO: Student Implement
+ */
+void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  if (!GetBitmap(extent_id)->DeAllocatePage(logical_page_id % BITMAP_SIZE)) {
+    return;
+  }
+  bitmaps_[extent_id]->dirty_ = true;
+  meta_page->num_allocated_pages_--;
+  uint32_t *used_pages = GetExtentUsedPageSlot(extent_id, true);
+  if (--*used_pages == 0) {
+    meta_page->num_extents_--;
+  }
+  meta_dirty_ = true;
+  first_free_extent_ = std::min(first_free_extent_, extent_id);
 }
 
 /**
  * TODO: Student Implement
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-	//get the bitmap page(physical!!)
-	page_id_t bitmap_index = (logical_page_id / BITMAP_SIZE) * (BITMAP_SIZE + 1) + 1; // +1 Disk Meta Page 
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  return GetBitmap(logical_page_id / BITMAP_SIZE)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
+
+uint32_t DiskManager::GetExtentUsedPages(uint32_t extent_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  return ExtentUsedPages(extent_id);
+}
+
+uint32_t *DiskManager::GetExtentUsedPageSlot(uint32_t extent_id, bool for_update) {
+  if (extent_id < DiskFileMetaPage::MAX_EXTENTS) {
+    meta_dirty_ = meta_dirty_ || for_update;
+    return reinterpret_cast<DiskFileMetaPage *>(meta_data_)->extent_used_page_ + extent_id;
+  }
+  extent_id -= DiskFileMetaPage::MAX_EXTENTS;
+  size_t index = extent_id / DiskFileMetaOverflowPage::MAX_EXTENTS;
+  while (meta_overflow_pages_.size() <= index) {
+    if (!for_update) {
+      return nullptr;
+    }
+    AddMetaOverflowPage();
+  }
+  MetaOverflowPage *page = meta_overflow_pages_[index].get();
+  page->dirty_ = page->dirty_ || for_update;
+  return reinterpret_cast<DiskFileMetaOverflowPage *>(page->data_)->extent_used_page_ +
+         extent_id % DiskFileMetaOverflowPage::MAX_EXTENTS;
+}
+
+void DiskManager::AddMetaOverflowPage() {
+  auto page = std::make_unique<MetaOverflowPage>();
+  memset(page->data_, 0, PAGE_SIZE);
+  reinterpret_cast<DiskFileMetaOverflowPage *>(page->data_)->next_page_id_ = INVALID_PAGE_ID;
+  page->dirty_ = true;
+  size_t index = meta_overflow_pages_.size();
+  meta_overflow_pages_.push_back(std::move(page));
+  // the page may land in an extent whose count it holds itself, or make room for the next overflow page first
+  page_id_t page_id = AllocatePage();
+  meta_overflow_pages_[index]->page_id_ = page_id;
+  if (index == 0) {
+    reinterpret_cast<DiskFileMetaPage *>(meta_data_)->next_page_id_ = page_id;
+    meta_dirty_ = true;
+  } else {
+    reinterpret_cast<DiskFileMetaOverflowPage *>(meta_overflow_pages_[index - 1]->data_)->next_page_id_ = page_id;
+    meta_overflow_pages_[index - 1]->dirty_ = true;
+  }
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  if (bitmaps_.size() <= extent_id) {
+    bitmaps_.resize(extent_id + 1);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    bitmaps_[extent_id] = std::make_unique<ExtentBitmap>();
+    ReadPhysicalPage(GetBitmapPhysicalPageId(extent_id), bitmaps_[extent_id]->data_);
+  }
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id]->data_);
+}
 
-	char bitmap[PAGE_SIZE];
-	ReadPhysicalPage(bitmap_index, bitmap); //read the bitmap
-	BitmapPage<PAGE_SIZE> *page = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap);  //transfer to BitMapPage
-	return page->IsPageFree(logical_page_id % BITMAP_SIZE);
+void DiskManager::FlushMetadata() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return;
+  }
+  alignas(PAGE_SIZE) char masked[PAGE_SIZE];
+  for (uint32_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (bitmaps_[extent_id] == nullptr || !bitmaps_[extent_id]->dirty_) {
+      continue;
+    }
+    // reserved pages that were not handed out yet are written as free
+    const char *data = bitmaps_[extent_id]->data_;
+    for (page_id_t page_id : reserved_pages_) {
+      if (page_id / BITMAP_SIZE != extent_id) {
+        continue;
+      }
+      if (data != masked) {
+        memcpy(masked, data, PAGE_SIZE);
+        data = masked;
+      }
+      reinterpret_cast<BitmapPage<PAGE_SIZE> *>(masked)->DeAllocatePage(page_id % BITMAP_SIZE);
+    }
+    WritePhysicalPage(GetBitmapPhysicalPageId(extent_id), data);
+    bitmaps_[extent_id]->dirty_ = false;
+  }
+  for (auto &page : meta_overflow_pages_) {
+    if (page->dirty_) {
+      WritePage(page->page_id_, page->data_);
+      page->dirty_ = false;
+    }
+  }
+  // the meta page goes last, so it never counts pages that the bitmaps on disk do not have, nor links to an overflow
+  // page that is not written yet
+  if (meta_dirty_) {
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
+    meta_dirty_ = false;
+  }
+}
+
+void DiskManager::ReclaimSpace() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  // the file keeps the meta page and everything up to the last allocated page, along with its extent's bitmap
+  int64_t end = META_PAGE_ID + 1;
+  // the meta page only counts the extents that hold pages, an empty one may sit below live ones, so every extent
+  // the file reaches or that has a cached bitmap is looked at
+  int64_t file_pages = static_cast<int64_t>(file_size_ / PAGE_SIZE);
+  size_t num_extents = file_pages <= META_PAGE_ID + 1 ? 0 : (file_pages - META_PAGE_ID - 2) / (BITMAP_SIZE + 1) + 1;
+  num_extents = std::max(num_extents, bitmaps_.size());
+  for (uint32_t extent_id = 0; extent_id < num_extents; extent_id++) {
+    auto *bitmap = GetBitmap(extent_id);
+    int64_t first = GetBitmapPhysicalPageId(extent_id) + 1;
+    uint32_t offset = 0;
+    while (offset < BITMAP_SIZE) {
+      if (!bitmap->IsPageFree(offset)) {
+        end = first + offset + 1;
+        offset++;
+        continue;
+      }
+      uint32_t run_end = offset + 1;
+      while (run_end < BITMAP_SIZE && bitmap->IsPageFree(run_end)) {
+        run_end++;
+      }
+      PunchPages(first + offset, first + run_end);
+      offset = run_end;
+    }
+  }
+  size_t size = static_cast<size_t>(end) * PAGE_SIZE;
+  if (size >= file_size_) {
+    return;
+  }
+  if (ftruncate(fd_, size) != 0) {
+    LOG(ERROR) << "Failed to truncate " << file_name_ << ": " << strerror(errno);
+    return;
+  }
+  file_size_ = size;
+  // the bitmaps past the end have no page allocated and read as zeros again, they need not be written back
+  for (uint32_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (GetBitmapPhysicalPageId(extent_id) >= end) {
+      bitmaps_[extent_id].reset();
+    }
+  }
+}
+
+void DiskManager::PunchPages(int64_t first, int64_t last) {
+  size_t offset = static_cast<size_t>(first) * PAGE_SIZE;
+  size_t end = std::min<size_t>(static_cast<size_t>(last) * PAGE_SIZE, file_size_);
+  if (offset >= end) {
+    return;
+  }
+  // file systems that cannot punch holes keep the blocks
+  fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, end - offset);
 }
 
 /**
  * TODO: Student Implement
  */
-page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
-  return logical_page_id + logical_page_id / BITMAP_SIZE + 2;  // +2
+int64_t DiskManager::MapPageId(page_id_t logical_page_id) {
+  return static_cast<int64_t>(logical_page_id) + logical_page_id / BITMAP_SIZE + 2;  // +2
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+void DiskManager::ReadPhysicalPage(int64_t physical_page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+  // pages beyond the end of the file read as zeros
+  if (offset >= file_size_) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  int result = TransferPage(false, offset, page_data);
+  if (result != 0) {
+    LOG(ERROR) << "I/O error while reading: " << strerror(-result);
+  }
+}
+
+void DiskManager::WritePhysicalPage(int64_t physical_page_id, const char *page_data) {
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+  int result = TransferPage(true, offset, const_cast<char *>(page_data));
+  if (result != 0) {
+    LOG(ERROR) << "I/O error while writing: " << strerror(-result);
+  }
 }
 
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+void DiskManager::WriteCompressedPage(int64_t physical_page_id, const char *page_data) {
+  alignas(PAGE_SIZE) char image[PAGE_SIZE];
+  auto *header = reinterpret_cast<CompressedPageHeader *>(image);
+  size_t size = PageCompressor::Compress(page_data, PAGE_SIZE, image + sizeof(CompressedPageHeader),
+                                         PAGE_SIZE - sizeof(CompressedPageHeader));
+  if (size == 0) {
+    WritePhysicalPage(physical_page_id, page_data);
+    return;
+  }
+  // a page that does not save a block is still stored compressed, so that it reads back as a compressed page
+  header->magic_ = CompressedPageHeader::MAGIC;
+  header->size_ = size;
+  size_t stored = (sizeof(CompressedPageHeader) + size + block_size_ - 1) / block_size_ * block_size_;
+  memset(image + sizeof(CompressedPageHeader) + size, 0, stored - sizeof(CompressedPageHeader) - size);
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+  size_t done = 0;
+  while (done < stored) {
+    ssize_t n = pwrite(fd_, image + done, stored - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      // e.g. a block size O_DIRECT does not accept
+      WritePhysicalPage(physical_page_id, page_data);
+      return;
+    }
+    done += n;
+  }
+  // a page at the end of the file leaves it shorter, the rest of the page reads as zeros
+  GrowFileSize(offset + PAGE_SIZE);
+  // the rest of the slot is not read any more, file systems that cannot punch holes just keep its blocks
+  if (stored < PAGE_SIZE) {
+    fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset + stored, PAGE_SIZE - stored);
+  }
+}
+
+bool DiskManager::DecompressPage(char *page_data) {
+  const auto *header = reinterpret_cast<const CompressedPageHeader *>(page_data);
+  if (header->magic_ != CompressedPageHeader::MAGIC || header->size_ > PAGE_SIZE - sizeof(CompressedPageHeader)) {
+    return false;
+  }
+  char page[PAGE_SIZE];
+  if (!PageCompressor::Decompress(page_data + sizeof(CompressedPageHeader), header->size_, page, PAGE_SIZE)) {
+    LOG(ERROR) << "Failed to decompress a page of " << file_name_;
+    return false;
+  }
+  memcpy(page_data, page, PAGE_SIZE);
+  return true;
+}
+
+int DiskManager::TransferPage(bool is_write, size_t offset, char *page_data, size_t done) {
+  // e.g. an io_uring request that completed in full
+  if (done == PAGE_SIZE) {
+    if (is_write) {
+      GrowFileSize(offset + PAGE_SIZE);
+    }
+    return 0;
+  }
+  // direct I/O transfers whole blocks from and to aligned memory only, a partial one is redone through the bounce
+  alignas(PAGE_SIZE) char bounce[PAGE_SIZE];
+  char *data = page_data;
+  if (direct_io_ && (reinterpret_cast<uintptr_t>(page_data) % PAGE_SIZE != 0 || done != 0)) {
+    data = bounce;
+    done = 0;
+    if (is_write) {
+      memcpy(bounce, page_data, PAGE_SIZE);
+    }
+  }
+  int result = 0;
+  while (done < PAGE_SIZE) {
+    ssize_t n = is_write ? pwrite(fd_, data + done, PAGE_SIZE - done, offset + done)
+                         : pread(fd_, data + done, PAGE_SIZE - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      result = -errno;
+      break;
+    }
+    if (n == 0) {
+      // end of file for a read, a write that makes no progress is an error
+      if (is_write) {
+        result = -EIO;
+      }
+      break;
+    }
+    done += n;
+  }
+  if (is_write) {
+    if (done == PAGE_SIZE) {
+      GrowFileSize(offset + PAGE_SIZE);
+    }
+    return result;
+  }
+  if (done < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-    memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-#ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
-#endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(data + done, 0, PAGE_SIZE - done);
+  }
+  if (data != page_data) {
+    memcpy(page_data, data, PAGE_SIZE);
   }
+  return result;
 }
 
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
+void DiskManager::GrowFileSize(size_t end) {
+  // concurrent writers may race to extend the file
+  size_t size = file_size_;
+  while (size < end && !file_size_.compare_exchange_weak(size, end)) {
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
@@ -0,0 +1,236 @@
+#include "storage/free_space_map.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+/** Fill a map page with the entries from its index on, linking it to next_page_id. */
+static void FillPage(FreeSpacePage *page, size_t index, page_id_t next_page_id, const std::vector<page_id_t> &page_ids,
+                     const std::vector<uint16_t> &free_spaces) {
+  size_t begin = index * FreeSpacePage::CAPACITY;
+  size_t end = std::min<size_t>(begin + FreeSpacePage::CAPACITY, page_ids.size());
+  page->next_page_id_ = next_page_id;
+  page->count_ = end - begin;
+  std::copy(page_ids.begin() + begin, page_ids.begin() + end, page->page_ids_);
+  std::copy(free_spaces.begin() + begin, free_spaces.begin() + end, page->free_spaces_);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), first_page_id_(first_page_id), tree_(2, 0) {
+  std::vector<page_id_t> page_ids;
+  std::vector<uint16_t> free_spaces;
+  for (page_id_t map_page_id = first_page_id_; map_page_id != INVALID_PAGE_ID;) {
+    Page *map_page = buffer_pool_manager_->FetchPage(map_page_id);
+    if (map_page == nullptr) {
+      LOG(WARNING) << "Can not read page " << map_page_id << " of the free space map " << first_page_id_;
+      map_page_ids_.clear();
+      loaded_ = false;
+      return;
+    }
+    auto *page = reinterpret_cast<FreeSpacePage *>(map_page->GetData());
+    map_page_ids_.push_back(map_page_id);
+    page_ids.insert(page_ids.end(), page->page_ids_, page->page_ids_ + page->count_);
+    free_spaces.insert(free_spaces.end(), page->free_spaces_, page->free_spaces_ + page->count_);
+    page_id_t next_page_id = page->next_page_id_;
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+    map_page_id = next_page_id;
+  }
+  SetEntries(std::move(page_ids), free_spaces);
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size) const {
+  if (tree_[1] < size) {
+    return INVALID_PAGE_ID;
+  }
+  size_t node = 1;
+  while (node < leaf_base_) {
+    node = tree_[2 * node] >= size ? 2 * node : 2 * node + 1;
+  }
+  return page_ids_[node - leaf_base_];
+}
+
+page_id_t FreeSpaceMap::GetLastPageId() const {
+  for (size_t entry = page_ids_.size(); entry > 0; entry--) {
+    if (page_ids_[entry - 1] != INVALID_PAGE_ID) {
+      return page_ids_[entry - 1];
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+bool FreeSpaceMap::AddPage(page_id_t page_id, uint32_t free_space) {
+  size_t entry = page_ids_.size();
+  if (!WriteEntry(entry, page_id, free_space)) {
+    return false;
+  }
+  page_ids_.push_back(page_id);
+  slots_[page_id] = entry;
+  if (entry == leaf_base_) {
+    // grow the tree to twice the leaves, the old tree becomes the left half
+    std::vector<uint16_t> tree(4 * leaf_base_, 0);
+    for (size_t level = 1; level <= leaf_base_; level *= 2) {
+      std::copy(tree_.begin() + level, tree_.begin() + 2 * level, tree.begin() + 2 * level);
+    }
+    tree[1] = tree[2];
+    tree_.swap(tree);
+    leaf_base_ *= 2;
+  }
+  SetTreeValue(entry, free_space);
+  return true;
+}
+
+bool FreeSpaceMap::UpdatePage(page_id_t page_id, uint32_t free_space) {
+  auto it = slots_.find(page_id);
+  if (it == slots_.end()) {
+    return AddPage(page_id, free_space);
+  }
+  if (tree_[leaf_base_ + it->second] == free_space) {
+    return true;
+  }
+  if (!WriteEntry(it->second, page_id, free_space)) {
+    return false;
+  }
+  SetTreeValue(it->second, free_space);
+  return true;
+}
+
+bool FreeSpaceMap::RemovePage(page_id_t page_id) {
+  auto it = slots_.find(page_id);
+  if (it == slots_.end()) {
+    return true;
+  }
+  size_t entry = it->second;
+  if (!WriteEntry(entry, INVALID_PAGE_ID, 0)) {
+    return false;
+  }
+  slots_.erase(it);
+  page_ids_[entry] = INVALID_PAGE_ID;
+  SetTreeValue(entry, 0);
+  // a failed compaction is tried again with the next removal
+  if (page_ids_.size() > 2 * slots_.size()) {
+    Compact();
+  }
+  return true;
+}
+
+void FreeSpaceMap::Destroy() {
+  for (page_id_t map_page_id : map_page_ids_) {
+    buffer_pool_manager_->DeletePage(map_page_id);
+  }
+  map_page_ids_.clear();
+  page_ids_.clear();
+  slots_.clear();
+  tree_.assign(2, 0);
+  leaf_base_ = 1;
+  first_page_id_ = INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::SetEntries(std::vector<page_id_t> page_ids, const std::vector<uint16_t> &free_spaces) {
+  page_ids_ = std::move(page_ids);
+  slots_.clear();
+  leaf_base_ = 1;
+  while (leaf_base_ < page_ids_.size()) {
+    leaf_base_ *= 2;
+  }
+  tree_.assign(2 * leaf_base_, 0);
+  for (size_t entry = 0; entry < page_ids_.size(); entry++) {
+    if (page_ids_[entry] != INVALID_PAGE_ID) {
+      slots_[page_ids_[entry]] = entry;
+      tree_[leaf_base_ + entry] = free_spaces[entry];
+    }
+  }
+  for (size_t node = leaf_base_ - 1; node > 0; node--) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
+
+bool FreeSpaceMap::WriteEntry(size_t entry, page_id_t page_id, uint16_t free_space) {
+  size_t index = entry / FreeSpacePage::CAPACITY;
+  if (index == map_page_ids_.size()) {
+    page_id_t map_page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(map_page_id);
+    if (new_page == nullptr) {
+      return false;
+    }
+    reinterpret_cast<FreeSpacePage *>(new_page->GetData())->Init();
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    if (!map_page_ids_.empty()) {
+      Page *last_page = buffer_pool_manager_->FetchPage(map_page_ids_.back());
+      if (last_page == nullptr) {
+        buffer_pool_manager_->DeletePage(map_page_id);
+        return false;
+      }
+      reinterpret_cast<FreeSpacePage *>(last_page->GetData())->next_page_id_ = map_page_id;
+      buffer_pool_manager_->UnpinPage(map_page_ids_.back(), true);
+    } else {
+      first_page_id_ = map_page_id;
+    }
+    map_page_ids_.push_back(map_page_id);
+  }
+  Page *map_page = buffer_pool_manager_->FetchPage(map_page_ids_[index]);
+  if (map_page == nullptr) {
+    return false;
+  }
+  auto *page = reinterpret_cast<FreeSpacePage *>(map_page->GetData());
+  size_t slot = entry % FreeSpacePage::CAPACITY;
+  page->page_ids_[slot] = page_id;
+  page->free_spaces_[slot] = free_space;
+  page->count_ = std::max<uint32_t>(page->count_, slot + 1);
+  buffer_pool_manager_->UnpinPage(map_page_ids_[index], true);
+  return true;
+}
+
+bool FreeSpaceMap::Compact() {
+  std::vector<page_id_t> page_ids;
+  std::vector<uint16_t> free_spaces;
+  for (size_t entry = 0; entry < page_ids_.size(); entry++) {
+    if (page_ids_[entry] != INVALID_PAGE_ID) {
+      page_ids.push_back(page_ids_[entry]);
+      free_spaces.push_back(tree_[leaf_base_ + entry]);
+    }
+  }
+  // the first page stays, the heap records it
+  size_t num_map_pages = std::max<size_t>((page_ids.size() + FreeSpacePage::CAPACITY - 1) / FreeSpacePage::CAPACITY, 1);
+  std::vector<page_id_t> map_page_ids(num_map_pages, INVALID_PAGE_ID);
+  map_page_ids[0] = first_page_id_;
+  auto delete_new_pages = [&](size_t from) {
+    for (size_t index = from; index < num_map_pages; index++) {
+      buffer_pool_manager_->DeletePage(map_page_ids[index]);
+    }
+  };
+  // write the new chain from its end on, so that each page can be linked to the one after it
+  for (size_t index = num_map_pages - 1; index > 0; index--) {
+    page_id_t next_page_id = index + 1 < num_map_pages ? map_page_ids[index + 1] : INVALID_PAGE_ID;
+    page_id_t map_page_id;
+    Page *map_page = buffer_pool_manager_->NewPage(map_page_id);
+    if (map_page == nullptr) {
+      delete_new_pages(index + 1);
+      return false;
+    }
+    FillPage(reinterpret_cast<FreeSpacePage *>(map_page->GetData()), index, next_page_id, page_ids, free_spaces);
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    map_page_ids[index] = map_page_id;
+  }
+  Page *first_page = buffer_pool_manager_->FetchPage(first_page_id_);
+  if (first_page == nullptr) {
+    delete_new_pages(1);
+    return false;
+  }
+  FillPage(reinterpret_cast<FreeSpacePage *>(first_page->GetData()), 0,
+           num_map_pages > 1 ? map_page_ids[1] : INVALID_PAGE_ID, page_ids, free_spaces);
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  for (size_t index = 1; index < map_page_ids_.size(); index++) {
+    buffer_pool_manager_->DeletePage(map_page_ids_[index]);
+  }
+  map_page_ids_.swap(map_page_ids);
+  SetEntries(std::move(page_ids), free_spaces);
+  return true;
+}
+
+void FreeSpaceMap::SetTreeValue(size_t entry, uint16_t free_space) {
+  size_t node = leaf_base_ + entry;
+  tree_[node] = free_space;
+  for (node /= 2; node > 0; node /= 2) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
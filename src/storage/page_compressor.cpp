@@ -0,0 +1,149 @@
+#include "storage/page_compressor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+static inline uint32_t Load32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/** Write the continuation bytes of a length whose nibble is 15. @return false if dst is full */
+static inline bool WriteLength(size_t length, uint8_t *&op, const uint8_t *op_end) {
+  for (length -= 15;; length -= 255) {
+    if (op == op_end) {
+      return false;
+    }
+    if (length < 255) {
+      *op++ = static_cast<uint8_t>(length);
+      return true;
+    }
+    *op++ = 255;
+  }
+}
+
+/** Add the continuation bytes of a length whose nibble is 15. @return false if src ends first */
+static inline bool ReadLength(size_t &length, const uint8_t *&ip, const uint8_t *ip_end) {
+  while (true) {
+    if (ip == ip_end) {
+      return false;
+    }
+    uint8_t byte = *ip++;
+    length += byte;
+    if (byte < 255) {
+      return true;
+    }
+  }
+}
+
+/** Append a sequence, without a match if match_length is 0. @return false if dst is full */
+static bool WriteSequence(const uint8_t *literals, size_t literal_length, size_t offset, size_t match_length,
+                          uint8_t *&op, const uint8_t *op_end) {
+  if (op == op_end) {
+    return false;
+  }
+  uint8_t *token = op++;
+  *token = static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4);
+  if (literal_length >= 15 && !WriteLength(literal_length, op, op_end)) {
+    return false;
+  }
+  if (static_cast<size_t>(op_end - op) < literal_length) {
+    return false;
+  }
+  memcpy(op, literals, literal_length);
+  op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+  if (op_end - op < 2) {
+    return false;
+  }
+  *op++ = static_cast<uint8_t>(offset);
+  *op++ = static_cast<uint8_t>(offset >> 8);
+  size_t length = match_length - PageCompressor::MIN_MATCH;
+  *token |= static_cast<uint8_t>(std::min<size_t>(length, 15));
+  return length < 15 || WriteLength(length, op, op_end);
+}
+
+size_t PageCompressor::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) {
+  ASSERT(src_size <= MAX_INPUT_SIZE, "Input too large.");
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *op_end = op + dst_capacity;
+  // position + 1 of the last 4 byte sequence with a hash, 0 if there was none
+  uint16_t table[1 << HASH_BITS];
+  memset(table, 0, sizeof(table));
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= src_size) {
+    uint32_t sequence = Load32(in + pos);
+    uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+    size_t candidate = table[hash];
+    table[hash] = static_cast<uint16_t>(pos + 1);
+    if (candidate == 0 || Load32(in + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    size_t match = candidate - 1;
+    size_t length = MIN_MATCH;
+    while (pos + length < src_size && in[match + length] == in[pos + length]) {
+      length++;
+    }
+    if (!WriteSequence(in + anchor, pos - anchor, pos - match, length, op, op_end)) {
+      return 0;
+    }
+    pos += length;
+    anchor = pos;
+  }
+  if (!WriteSequence(in + anchor, src_size - anchor, 0, 0, op, op_end)) {
+    return 0;
+  }
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+bool PageCompressor::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip_end = ip + src_size;
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  auto *out = op;
+  const uint8_t *op_end = op + dst_size;
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(literal_length, ip, ip_end)) {
+      return false;
+    }
+    if (static_cast<size_t>(ip_end - ip) < literal_length || static_cast<size_t>(op_end - op) < literal_length) {
+      return false;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == ip_end) {
+      break;
+    }
+    if (ip_end - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLength(match_length, ip, ip_end)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - out) || static_cast<size_t>(op_end - op) < match_length) {
+      return false;
+    }
+    // the match may overlap the bytes it produces, e.g. a run of one byte has offset 1
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < match_length; i++) {
+      op[i] = match[i];
+    }
+    op += match_length;
+  }
+  return op == op_end;
+}
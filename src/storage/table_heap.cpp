@@ -1,61 +1,151 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+
 /**
  * TODO: Student Implement
  */
 
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-  //search the TableHeap find a TablePage to insert the tuple
-	auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(GetFirstPageId())); //start from the root of TableHeap
-	page_id_t page_id;
-	bool success;
+	uint32_t serialized_size = row.GetSerializedSize(schema_);
+	if(serialized_size > TablePage::SIZE_MAX_ROW)  //does not fit into an empty page either
+		return false;
+	uint32_t space_needed = TablePage::GetSpaceNeeded(serialized_size);
+	FreeSpaceMap *free_space_map = GetFreeSpaceMap();
+	if(free_space_map == nullptr)
+		return false;
 
-	while(1)
+	//try the first page with room, a page that turns out to be fuller gets its entry corrected
+	page_id_t page_id;
+	while((page_id = free_space_map->FindPage(space_needed)) != INVALID_PAGE_ID)
 	{
+		auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id));
 		if(page == nullptr)
-			return false;	
-		
-		//try to insert
+			return false;
+
 		page->WLatch();
-		success = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+		bool success = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
 		page->WUnlatch();
-		
+		bool updated = free_space_map->UpdatePage(page_id, page->GetFreeSpaceRemaining());
+
 		if(success)  //finish
 		{
-			buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-
+			if(compressed_)
+				page->SetCompressed(true);
+			buffer_pool_manager_->UnpinPage(page_id, true);
 			return true;
 		}
-		
-		buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-		//try next page
-		page_id = page->GetNextPageId(); 
-		
-		if(page_id == INVALID_PAGE_ID) //-1
-			break;
-		page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id));
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		if(!updated)  //the map would find the same page again
+			return false;
 	}
-	
-	//get a new page to insert the tuple
-	//insert the new page to page->next
+
+	//no page has room: get a new page to insert the tuple and link it after the last page
+	page_id = free_space_map->GetLastPageId();
+	auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id));
+	if(page == nullptr)
+		return false;
 	page_id_t new_page_id;
-	page_id = page->GetTablePageId();
-	auto new_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->NewPage(new_page_id));
+	auto new_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->NewPage(new_page_id, &run_));
+	if(new_page == nullptr)
+	{
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		return false;
+	}
+	new_page->WLatch();
+	new_page->SetCompressed(compressed_);
+	new_page->Init(new_page_id, page_id, log_manager_, txn);
+	bool success = new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+	new_page->WUnlatch();
+
+	//the map has to know the page before it joins the chain, the next new page is linked after the map's last page
+	if(!free_space_map->AddPage(new_page_id, new_page->GetFreeSpaceRemaining()))
+	{
+		buffer_pool_manager_->UnpinPage(new_page_id, false);
+		buffer_pool_manager_->DeletePage(new_page_id);
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		return false;
+	}
 	page->WLatch();
 	page->SetNextPageId(new_page_id);
 	page->WUnlatch();
 	buffer_pool_manager_->UnpinPage(page_id, true);
-
-	new_page->WLatch();
-	new_page->Init(new_page_id, page_id, log_manager_, txn);
-	success = new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
-	new_page->WUnlatch();
-	buffer_pool_manager_->UnpinPage(new_page->GetTablePageId(), true);
+	buffer_pool_manager_->UnpinPage(new_page_id, true);
 
 	return success;
 }
 
 
+bool TableHeap::AppendTuple(Row &row, Transaction *txn) {
+  if (row.GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW) {
+    return false;
+  }
+  FreeSpaceMap *free_space_map = GetFreeSpaceMap();
+  if (free_space_map == nullptr) {
+    return false;
+  }
+  if (append_page_ == nullptr) {
+    page_id_t page_id = free_space_map->GetLastPageId();
+    append_page_ = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (append_page_ == nullptr) {
+      return false;
+    }
+    append_page_dirty_ = false;
+  }
+  append_page_->WLatch();
+  bool success = append_page_->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  append_page_->WUnlatch();
+  if (success) {
+    append_page_dirty_ = true;
+    return true;
+  }
+
+  // the last page is full: link a new page to it and continue there
+  page_id_t page_id = append_page_->GetTablePageId();
+  page_id_t new_page_id;
+  auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id, &run_));
+  if (new_page == nullptr) {
+    return false;
+  }
+  new_page->WLatch();
+  new_page->SetCompressed(compressed_);
+  new_page->Init(new_page_id, page_id, log_manager_, txn);
+  new_page->WUnlatch();
+  if (!free_space_map->AddPage(new_page_id, new_page->GetFreeSpaceRemaining())) {
+    buffer_pool_manager_->UnpinPage(new_page_id, false);
+    buffer_pool_manager_->DeletePage(new_page_id);
+    return false;
+  }
+  append_page_->WLatch();
+  append_page_->SetNextPageId(new_page_id);
+  append_page_->WUnlatch();
+  append_page_dirty_ = true;
+  EndAppend();
+  append_page_ = new_page;
+  append_page_dirty_ = true;
+
+  append_page_->WLatch();
+  success = append_page_->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  append_page_->WUnlatch();
+  return success;
+}
+
+void TableHeap::EndAppend() {
+  if (append_page_ == nullptr) {
+    return;
+  }
+  page_id_t page_id = append_page_->GetTablePageId();
+  if (append_page_dirty_) {
+    GetFreeSpaceMap()->UpdatePage(page_id, append_page_->GetFreeSpaceRemaining());
+    if (compressed_) {
+      append_page_->SetCompressed(true);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, append_page_dirty_);
+  append_page_ = nullptr;
+  append_page_dirty_ = false;
+}
+
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -65,10 +155,13 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  bool success = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  return true;
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), success);
+  if (success) {
+    dead_tuples_++;
+  }
+  return success;
 }
 
 /**
@@ -108,6 +201,13 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
 		return false;
 	}
 
+  FreeSpaceMap *free_space_map = GetFreeSpaceMap();
+  if (free_space_map != nullptr) {
+    free_space_map->UpdatePage(page->GetTablePageId(), page->GetFreeSpaceRemaining());
+  }
+  if (compressed_) {
+    page->SetCompressed(true);
+  }
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   return true;
 }
@@ -116,7 +216,6 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
  * TODO: Student Implement
  */
 
-//TODO: if a page is empty, we should free it !!
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step1: Find the page which contains the tuple.
   // Step2: Delete the tuple from the page.
@@ -127,58 +226,121 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
 	page->WLatch();
 	page->ApplyDelete(rid, txn, log_manager_);
 	page->WUnlatch();
-	
-	//delete if empty
-	if(page->IsEmpty())
-	{
-		page_id_t page_id, next_page_id, prev_page_id;
 
-		page_id      = page->GetTablePageId();
-		next_page_id = page->GetNextPageId();
-		prev_page_id = page->GetPrevPageId();
-		
-		buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-		//try to delete the page from buffer_pool  may fail if someone has Pinned it
-
-		if(next_page_id == INVALID_PAGE_ID && prev_page_id == INVALID_PAGE_ID)
-		{ //if it is the only page in the Table Heap, remain it
-			return;
-		}else if(next_page_id == INVALID_PAGE_ID)
-		{	
-			buffer_pool_manager_->DeletePage(page_id);
-			
-			auto prev_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(prev_page_id));
-			prev_page->WLatch();
-			prev_page->SetNextPageId(INVALID_PAGE_ID);  // prev now invalid --->   prev_of_prev  prev  invalid
-			prev_page->WUnlatch();
-			buffer_pool_manager_->UnpinPage(prev_page_id, true);
-			return;
-		}else if(prev_page_id == INVALID_PAGE_ID)
-		{
-			buffer_pool_manager_->DeletePage(page_id);
-			if(page_id == first_page_id_)   //must be?
-				first_page_id_ = next_page_id;  //change the first page id
-			
-			auto next_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(next_page_id));
-			next_page->WLatch();
-			next_page->SetPrevPageId(INVALID_PAGE_ID);  // invalid now next --->   invalid  next
-			next_page->WUnlatch();
-			buffer_pool_manager_->UnpinPage(next_page_id, true);
-		}else
-		{
-			auto next_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(next_page_id));
-			next_page->WLatch();
-			next_page->SetPrevPageId(prev_page_id);  
-			next_page->WUnlatch();
-			buffer_pool_manager_->UnpinPage(next_page_id, true);
-			
-			auto prev_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(prev_page_id));
-			prev_page->WLatch();
-			prev_page->SetNextPageId(next_page_id); 
-			prev_page->WUnlatch();
-			buffer_pool_manager_->UnpinPage(prev_page_id, true);
-		}
+	page_id_t page_id = page->GetTablePageId();
+	FreeSpaceMap *free_space_map = GetFreeSpaceMap();
+	if(free_space_map == nullptr)  //an empty page stays until a vacuum can take it out
+	{
+		buffer_pool_manager_->UnpinPage(page_id, true);
+		return;
+	}
+	//the first page stays even if it is empty, the catalog and the free space map hang off it
+	if(!page->IsEmpty() || page_id == first_page_id_)
+	{
+		free_space_map->UpdatePage(page_id, page->GetFreeSpaceRemaining());
+		buffer_pool_manager_->UnpinPage(page_id, true);
+		return;
 	}
+
+	//unlink the empty page and free it
+	page_id_t next_page_id = page->GetNextPageId();
+	page_id_t prev_page_id = page->GetPrevPageId();
+	buffer_pool_manager_->UnpinPage(page_id, true);
+	RemovePage(page_id, prev_page_id, next_page_id);
+}
+
+VacuumStats TableHeap::Vacuum() {
+  VacuumStats stats;
+  EndAppend();
+  DeleteRemovedPages();
+  FreeSpaceMap *free_space_map = GetFreeSpaceMap();
+  if (free_space_map == nullptr) {
+    return stats;
+  }
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      break;
+    }
+    // keep the pages ahead on their way in while this one is compacted
+    if (stats.pages_scanned_++ % (DEFAULT_READ_AHEAD_PAGES / 2) == 0) {
+      buffer_pool_manager_->ReadAhead(page->GetNextPageId(), DEFAULT_READ_AHEAD_PAGES, NextPageId);
+    }
+    page->WLatch();
+    uint32_t free_space = page->GetFreeSpaceRemaining();
+    uint32_t removed = page->Vacuum();
+    uint32_t new_free_space = page->GetFreeSpaceRemaining();
+    bool empty = page->IsEmpty();
+    page_id_t prev_page_id = page->GetPrevPageId();
+    page_id_t next_page_id = page->GetNextPageId();
+    page->WUnlatch();
+    if (removed > 0 && compressed_) {
+      page->SetCompressed(true);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, removed > 0);
+
+    stats.tuples_removed_ += removed;
+    stats.bytes_reclaimed_ += new_free_space - free_space;
+    if (empty && page_id != first_page_id_ && RemovePage(page_id, prev_page_id, next_page_id)) {
+      stats.pages_freed_++;
+    } else if (removed > 0) {
+      free_space_map->UpdatePage(page_id, new_free_space);
+    }
+    page_id = next_page_id;
+  }
+  dead_tuples_ = 0;
+  return stats;
+}
+
+bool TableHeap::NeedsVacuum() {
+  FreeSpaceMap *free_space_map = GetFreeSpaceMap();
+  return dead_tuples_ > 0 && free_space_map != nullptr && dead_tuples_ >= free_space_map->GetPageCount();
+}
+
+bool TableHeap::RemovePage(page_id_t page_id, page_id_t prev_page_id, page_id_t next_page_id) {
+  // pin the neighbours first, so that unlinking can not fail halfway; a page that stays is taken out by a later
+  // delete or vacuum
+  auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+  if (prev_page == nullptr) {
+    return false;
+  }
+  TablePage *next_page = nullptr;
+  if (next_page_id != INVALID_PAGE_ID) {
+    next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    if (next_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+      return false;
+    }
+  }
+  if (!GetFreeSpaceMap()->RemovePage(page_id)) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    if (next_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+    }
+    return false;
+  }
+  prev_page->WLatch();
+  prev_page->SetNextPageId(next_page_id);
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  if (next_page != nullptr) {
+    next_page->WLatch();
+    next_page->SetPrevPageId(prev_page_id);
+    next_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(next_page_id, true);
+  }
+  // a scan on the page still follows its next page id, so the page is kept until it is unpinned
+  if (!buffer_pool_manager_->DeletePage(page_id)) {
+    removed_page_ids_.push_back(page_id);
+  }
+  return true;
+}
+
+void TableHeap::DeleteRemovedPages() {
+  auto kept = std::remove_if(removed_page_ids_.begin(), removed_page_ids_.end(),
+                             [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  removed_page_ids_.erase(kept, removed_page_ids_.end());
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -189,19 +351,22 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   page->WLatch();
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
+  if (dead_tuples_ > 0) {
+    dead_tuples_--;
+  }
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 /**
  * TODO: Student Implement
  */
-bool TableHeap::GetTuple(Row *row, Transaction *txn) {
+bool TableHeap::GetTuple(Row *row, Transaction *txn, BufferAccessStrategy *strategy) {
 	//according to TablePage::GetTuple  we need get Read lock before call TablePage::GetTuple
 	page_id_t page_id = row->GetRowId().GetPageId();  //get page id from row
 	if(page_id == -1)
 		return false;
 
-	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  //get the page
+	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, strategy));  //get the page
 	ASSERT(page != nullptr, "error in TableHeap::GetTuple");
 	
 	page->RLatch();
@@ -218,6 +383,10 @@ bool TableHeap::GetTuple(Row *row, Transaction *txn) {
 }
 
 void TableHeap::DeleteTable(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    EndAppend();
+    DestroyFreeSpaceMap();
+  }
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
     if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
@@ -226,30 +395,151 @@ void TableHeap::DeleteTable(page_id_t page_id) {
     buffer_pool_manager_->DeletePage(page_id);
   } else {
     DeleteTable(first_page_id_);
+    DeleteRemovedPages();
+    buffer_pool_manager_->ReleaseAllocationRun(&run_);
+  }
+}
+
+double TableHeap::GetFragmentation() {
+  size_t links = 0;
+  size_t jumps = 0;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      break;
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (next_page_id != INVALID_PAGE_ID) {
+      links++;
+      jumps += next_page_id != page_id + 1 ? 1 : 0;
+    }
+    page_id = next_page_id;
+  }
+  return links == 0 ? 0 : static_cast<double>(jumps) / links;
+}
+
+FreeSpaceMap *TableHeap::GetFreeSpaceMap() {
+  if (free_space_map_ != nullptr) {
+    return free_space_map_.get();
+  }
+  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  if (first_page == nullptr) {
+    return nullptr;
+  }
+  page_id_t map_page_id = first_page->GetFreeSpaceMapPageId();
+  if (map_page_id != 0) {
+    free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, map_page_id);
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    if (!free_space_map_->IsLoaded()) {
+      free_space_map_.reset();
+    }
+    return free_space_map_.get();
+  }
+  // a heap without a map yet: record its pages in chain order
+  free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      break;
+    }
+    bool added = free_space_map_->AddPage(page_id, page->GetFreeSpaceRemaining());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!added) {
+      break;
+    }
+    page_id = next_page_id;
+  }
+  if (page_id != INVALID_PAGE_ID) {
+    // a page could not be read or recorded, the map is built again on the next use
+    free_space_map_->Destroy();
+    free_space_map_.reset();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    return nullptr;
+  }
+  first_page->SetFreeSpaceMapPageId(free_space_map_->GetFirstPageId());
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  return free_space_map_.get();
+}
+
+void TableHeap::DestroyFreeSpaceMap() {
+  if (free_space_map_ == nullptr) {
+    auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+    if (first_page == nullptr) {
+      return;
+    }
+    page_id_t map_page_id = first_page->GetFreeSpaceMapPageId();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    if (map_page_id == 0) {
+      return;
+    }
+    free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, map_page_id);
+    if (!free_space_map_->IsLoaded()) {
+      free_space_map_.reset();
+      return;
+    }
+  }
+  free_space_map_->Destroy();
+  free_space_map_.reset();
+}
+
+void TableHeap::SetCompression(bool compressed) {
+  compressed_ = compressed;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      break;
+    }
+    page->SetCompressed(compressed);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page_id = next_page_id;
   }
 }
 
 /**
  * TODO: Student Implement
  */
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   //return the first tuple in first page
 	page_id_t page_id;
 	page_id = GetFirstPageId();
-	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, strategy));
 	
 	//get first tuple rid
 	RowId row_id;
-	page->GetFirstTupleRid(&row_id);
 	bool success;
 
 	page->RLatch();
-	page->GetFirstTupleRid(&row_id);  //get the first tuple id in the first page
+	success = page->GetFirstTupleRid(&row_id);  //get the first tuple id in the first page
 	page->RUnlatch();
 
-	Row row(row_id);
-	buffer_pool_manager_->UnpinPage(page_id, false);
-	return TableIterator(this, row, txn);
+	// start reading the following pages of the chain while the first one is being scanned
+	buffer_pool_manager_->ReadAhead(page->GetNextPageId(), DEFAULT_READ_AHEAD_PAGES, NextPageId, strategy);
+
+	//the first page may have no tuples left, start at the first page that has
+	while(!success && page->GetNextPageId() != INVALID_PAGE_ID)
+	{
+		page_id_t next_page_id = page->GetNextPageId();
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		page_id = next_page_id;
+		page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, strategy));
+		page->RLatch();
+		success = page->GetFirstTupleRid(&row_id);
+		page->RUnlatch();
+	}
+
+	if(!success)
+	{
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		return TableIterator(this, nullptr, INVALID_ROWID, txn, strategy);
+	}
+	//the iterator takes over the pin of the page
+	return TableIterator(this, page, row_id, txn, strategy);
 }
 
 /**
@@ -6,18 +6,35 @@
 /**
  * TODO: Student Implement
  */
-TableIterator::TableIterator(TableHeap *th, Row row, Transaction *txn): th_(th), row_(row), txn_(txn){
+TableIterator::TableIterator(TableHeap *th, Row row, Transaction *txn, BufferAccessStrategy *strategy)
+    : th_(th), row_(row), txn_(txn), strategy_(strategy) {
 	if(!(row_.GetRowId().GetPageId() == INVALID_ROWID.GetPageId() && row_.GetRowId().GetSlotNum() == INVALID_ROWID.GetSlotNum()))
 	{
-		th_->GetTuple(&row_, txn_);
+		page_ = reinterpret_cast<TablePage *>(th_->buffer_pool_manager_->FetchPage(row_.GetRowId().GetPageId(), strategy_));
 	}
 }
 
-TableIterator::TableIterator(const TableIterator &other): th_(other.th_), row_(other.row_), txn_(other.txn_){}
+TableIterator::TableIterator(TableHeap *th, TablePage *page, const RowId &rid, Transaction *txn,
+                             BufferAccessStrategy *strategy)
+    : th_(th), row_(rid), txn_(txn), strategy_(strategy), page_(page) {}
 
+TableIterator::TableIterator(const TableIterator &other)
+    : th_(other.th_), row_(other.row_), txn_(other.txn_), strategy_(other.strategy_), row_read_(other.row_read_),
+      pages_entered_(other.pages_entered_) {
+	//the copy holds a pin of its own
+	if(other.page_ != nullptr)
+		page_ = reinterpret_cast<TablePage *>(th_->buffer_pool_manager_->FetchPage(other.page_->GetTablePageId(), strategy_));
+}
+
+TableIterator::TableIterator(TableIterator &&other) noexcept
+    : th_(other.th_), row_(std::move(other.row_)), txn_(other.txn_), strategy_(other.strategy_),
+      page_(other.page_), row_read_(other.row_read_), pages_entered_(other.pages_entered_) {
+	other.page_ = nullptr;
+}
 
-TableIterator::~TableIterator() {
 
+TableIterator::~TableIterator() {
+	ReleasePage();
 }
 
 
@@ -38,73 +55,118 @@ bool TableIterator::operator!=(const TableIterator &itr) const {
 }
 const Row &TableIterator::operator*() {
 	ASSERT(*this != th_->End(), "End itr can not *"); 
+	ReadRow();
 	return row_;
 }
 
 Row *TableIterator::operator->() {
+	ReadRow();
   return &row_;
 }
 
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
+	if(this == &itr)
+		return *this;
+	ReleasePage();
 	th_ = itr.th_;
 	row_ = itr.row_;
 	txn_ = itr.txn_;
+	strategy_ = itr.strategy_;
+	row_read_ = itr.row_read_;
+	pages_entered_ = itr.pages_entered_;
+	if(itr.page_ != nullptr)
+		page_ = reinterpret_cast<TablePage *>(th_->buffer_pool_manager_->FetchPage(itr.page_->GetTablePageId(), strategy_));
+	return *this;
+}
+
+TableIterator &TableIterator::operator=(TableIterator &&itr) noexcept {
+	if(this == &itr)
+		return *this;
+	ReleasePage();
+	th_ = itr.th_;
+	row_ = std::move(itr.row_);
+	txn_ = itr.txn_;
+	strategy_ = itr.strategy_;
+	row_read_ = itr.row_read_;
+	pages_entered_ = itr.pages_entered_;
+	page_ = itr.page_;
+	itr.page_ = nullptr;
 	return *this;
 }
 
 // ++iter
 TableIterator &TableIterator::operator++() {
+	if(page_ == nullptr)  //End()
+		return *this;
   BufferPoolManager *buffer_pool_manager = th_->buffer_pool_manager_;
 
-	auto page = reinterpret_cast<TablePage*>(buffer_pool_manager->FetchPage(row_.GetRowId().GetPageId()));
-	page->RLatch();
-	//ASSERT(page != nullptr, "error in operator++");
-	if(nullptr == page)
-	{
-		cout << "error in operator++" << endl;
-		return *this;
-	}
 	RowId next_row_id;
-	if(!(page->GetNextTupleRid(row_.GetRowId(), &next_row_id)))  //if this row is the last element of the page
+	page_->RLatch();
+	bool found = page_->GetNextTupleRid(row_.GetRowId(), &next_row_id);
+	page_id_t next_page_id = page_->GetNextPageId();
+	page_->RUnlatch();
+
+	//this row is the last one of its page, move on to the next page that has tuples
+	while(!found)
 	{
-		//try to get next page
-		if(page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page->GetNextPageId()));
-      page->RUnlatch();
-      buffer_pool_manager->UnpinPage(page->GetPageId(), false);
-      page = next_page;
-			page->RLatch(); 
-
-			if (!(page->GetFirstTupleRid(&next_row_id)))
-			{
-				cout << "SHOULD NOT REACH HERE" << endl;
-			}
-		}else{
+		if(next_page_id == INVALID_PAGE_ID)
+		{
 			//No next page ? End()
-			next_row_id = INVALID_ROWID;
+			ReleasePage();
+			row_ = Row(INVALID_ROWID);
+			return *this;
 		}
-	}	
-
-
-	page->RUnlatch();
-	buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+		auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(next_page_id, strategy_));
+		ReleasePage();
+		page_ = next_page;
+		// half way through the pages read ahead last time, ask for the next batch
+		if (++pages_entered_ % (DEFAULT_READ_AHEAD_PAGES / 2) == 0) {
+			buffer_pool_manager->ReadAhead(page_->GetNextPageId(), DEFAULT_READ_AHEAD_PAGES, TableHeap::NextPageId, strategy_);
+		}
+		page_->RLatch();
+		found = page_->GetFirstTupleRid(&next_row_id);
+		next_page_id = page_->GetNextPageId();
+		page_->RUnlatch();
+	}
 
-	//set the row_ and get new tuple data
+	//set the row_, its tuple data is read from the pinned page once it is asked for
 	row_ = Row(next_row_id);
-
-	if(!(row_.GetRowId().GetPageId() == INVALID_ROWID.GetPageId() && row_.GetRowId().GetSlotNum() == INVALID_ROWID.GetSlotNum()))
-		th_->GetTuple(&row_, txn_);
+	row_read_ = false;
 
 	return *this;
 }
 
 // iter++
 TableIterator TableIterator::operator++(int) {
-  TableIterator clone(th_, row_, txn_);
+  TableIterator clone(*this);
 	++(*this);
 	return clone;
 }
 
 Row *TableIterator::GetRow() {
+	ReadRow();
   return &row_;
 }
+
+RowView TableIterator::GetRowView() {
+	ASSERT(page_ != nullptr, "End itr has no row");
+	const char *data = page_->GetTupleData(row_.GetRowId());
+	ASSERT(data != nullptr, "The tuple was deleted");
+	return RowView(data, th_->schema_);
+}
+
+void TableIterator::ReadRow() {
+	if(row_read_ || page_ == nullptr)
+		return;
+	page_->RLatch();
+	page_->GetTuple(&row_, th_->schema_, txn_, th_->lock_manager_);
+	page_->RUnlatch();
+	row_read_ = true;
+}
+
+void TableIterator::ReleasePage() {
+	if(page_ == nullptr)
+		return;
+	th_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+	page_ = nullptr;
+}
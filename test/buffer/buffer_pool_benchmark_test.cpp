@@ -0,0 +1,311 @@
+#include <sys/mman.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+/** Buffer pool micro benchmarks. */
+
+TEST(BufferPoolBenchmark, FetchThroughputByThreads) {
+  const std::string db_name = "bpm_bench.db";
+  const size_t buffer_pool_size = 1024;
+  const int num_pages = 1024;
+  const int fetches_per_config = 100000;
+
+  for (size_t num_shards : {1, 16}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_shards);
+    // every page is resident, so the benchmark measures the page table and latching only
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    for (int num_threads : {1, 2, 4, 8}) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          std::minstd_rand rng(t + 1);
+          for (int i = 0; i < fetches_per_config / num_threads; i++) {
+            page_id_t page_id = rng() % num_pages;
+            if (bpm->FetchPage(page_id) != nullptr) {
+              bpm->UnpinPage(page_id, false);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      double seconds = SecondsSince(start);
+      std::cout << "[bench] shards=" << std::setw(2) << num_shards << " threads=" << num_threads
+                << " fetch/s=" << static_cast<uint64_t>(fetches_per_config / seconds) << std::endl;
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolBenchmark, PointLookupHitRateUnderScan) {
+  const std::string db_name = "bpm_bench.db";
+  const size_t buffer_pool_size = 64;
+  const int num_hot_pages = 32;
+  const int num_scan_pages = 512;
+  const int scan_pages_per_lookup = 4;
+  const int num_lookups = 4000;
+  struct Config {
+    const char *name;
+    ReplacerType replacer_type;
+    bool scan_ring;
+  };
+
+  for (const Config &config : {Config{"LRU       ", ReplacerType::LRU, false},
+                               Config{"LRU-2     ", ReplacerType::LRUK, false},
+                               Config{"LRU + ring", ReplacerType::LRU, true}}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, config.replacer_type);
+    auto *strategy = config.scan_ring ? new BufferAccessStrategy(bpm, 8) : nullptr;
+    for (int i = 0; i < num_hot_pages + num_scan_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    // warm up: reference every hot page twice, like the upper levels of a B+ tree
+    for (int round = 0; round < 2; round++) {
+      for (page_id_t page_id = 0; page_id < num_hot_pages; page_id++) {
+        bpm->FetchPage(page_id);
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+    // point lookups on the hot pages, interleaved with a scan that sweeps through the remaining pages
+    std::minstd_rand rng(1);
+    page_id_t scan_cursor = 0;
+    uint64_t lookup_hits = 0;
+    for (int i = 0; i < num_lookups; i++) {
+      page_id_t page_id = rng() % num_hot_pages;
+      uint64_t hits_before = bpm->GetHitCount();
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+      lookup_hits += bpm->GetHitCount() - hits_before;
+      for (int j = 0; j < scan_pages_per_lookup; j++) {
+        page_id_t scan_page_id = num_hot_pages + scan_cursor;
+        scan_cursor = (scan_cursor + 1) % num_scan_pages;
+        ASSERT_NE(nullptr, bpm->FetchPage(scan_page_id, strategy));
+        bpm->UnpinPage(scan_page_id, false);
+      }
+    }
+    std::cout << "[bench] replacer=" << config.name << " point lookup hit rate=" << std::fixed
+              << std::setprecision(3) << static_cast<double>(lookup_hits) / num_lookups << std::endl;
+    delete strategy;
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolBenchmark, ReplacerOperations) {
+  const size_t num_frames = 4096;
+  const int num_ops = 1000000;
+  std::vector<frame_id_t> frames(num_ops);
+  std::minstd_rand rng(7);
+  for (auto &frame_id : frames) {
+    frame_id = rng() % num_frames;
+  }
+
+  for (ReplacerType replacer_type : {ReplacerType::LRU, ReplacerType::LRUK, ReplacerType::CLOCK}) {
+    Replacer *replacer;
+    const char *name;
+    switch (replacer_type) {
+      case ReplacerType::LRU:
+        replacer = new LRUReplacer(num_frames);
+        name = "LRU  ";
+        break;
+      case ReplacerType::LRUK:
+        replacer = new LRUKReplacer(num_frames);
+        name = "LRU-2";
+        break;
+      default:
+        replacer = new CLOCKReplacer(num_frames);
+        name = "CLOCK";
+        break;
+    }
+    for (size_t i = 0; i < num_frames; i++) {
+      replacer->Unpin(i);
+    }
+    // a fetch pins a frame and later unpins it; every fourth operation is a miss that needs a victim
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_ops; i++) {
+      frame_id_t frame_id = frames[i];
+      if (i % 4 == 0) {
+        ASSERT_TRUE(replacer->Victim(&frame_id));
+      }
+      replacer->Pin(frame_id);
+      replacer->Unpin(frame_id);
+    }
+    double seconds = SecondsSince(start);
+    std::cout << "[bench] replacer=" << name << " pin+unpin ops/s=" << static_cast<uint64_t>(num_ops / seconds)
+              << std::endl;
+    EXPECT_EQ(num_frames, replacer->Size());
+    delete replacer;
+  }
+}
+
+TEST(BufferPoolBenchmark, DirtyMissesWithPageCleaner) {
+  const std::string db_name = "bpm_bench.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 2048;
+  const int num_fetches = 20000;
+
+  for (bool cleaner : {false, true}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    uint64_t foreground_before = bpm->GetForegroundWriteCount();
+    if (cleaner) {
+      bpm->StartPageCleaner();
+    }
+    // every other fetch dirties its page, so a miss keeps running into dirty victims unless they were cleaned
+    std::minstd_rand rng(3);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_fetches; i++) {
+      page_id_t page_id = rng() % num_pages;
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      page->GetData()[i % PAGE_SIZE] = static_cast<char>(i);
+      bpm->UnpinPage(page_id, i % 2 == 0);
+    }
+    double seconds = SecondsSince(start);
+    bpm->StopPageCleaner();
+    std::cout << "[bench] cleaner=" << (cleaner ? "on " : "off")
+              << " fetch/s=" << static_cast<uint64_t>(num_fetches / seconds)
+              << " foreground writes=" << bpm->GetForegroundWriteCount() - foreground_before
+              << " cleaner writes=" << bpm->GetCleanerWriteCount() << std::endl;
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolBenchmark, ColdChainScanWithReadAhead) {
+  const std::string db_name = "bpm_bench.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 4096;
+  // each page stores the id of the next page of the chain at its start
+  auto next_page_id = [](Page *page) {
+    page_id_t next;
+    memcpy(&next, page->GetData(), sizeof(next));
+    return next;
+  };
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    BufferPoolManager bpm(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm.NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      page_id_t next = i + 1 < num_pages ? page_id + 1 : INVALID_PAGE_ID;
+      memcpy(page->GetData(), &next, sizeof(next));
+      bpm.UnpinPage(page_id, true);
+    }
+  }
+  for (int run = 0; run < 4; run++) {
+    bool read_ahead = run % 2 == 1;
+    bool scan_ring = run >= 2;
+    // a fresh pool on every run, so the scan starts cold
+    BufferPoolManager bpm(buffer_pool_size, disk_manager, DEFAULT_BUFFER_POOL_SHARDS);
+    BufferAccessStrategy ring(&bpm);
+    BufferAccessStrategy *strategy = scan_ring ? &ring : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    int pages_scanned = 0;
+    for (page_id_t page_id = 0; page_id != INVALID_PAGE_ID; pages_scanned++) {
+      if (read_ahead && pages_scanned % (DEFAULT_READ_AHEAD_PAGES / 2) == 0) {
+        bpm.ReadAhead(page_id, DEFAULT_READ_AHEAD_PAGES, next_page_id, strategy);
+      }
+      auto *page = bpm.FetchPage(page_id, strategy);
+      ASSERT_NE(nullptr, page);
+      page_id_t next = next_page_id(page);
+      bpm.UnpinPage(page_id, false);
+      page_id = next;
+    }
+    double seconds = SecondsSince(start);
+    std::cout << "[bench] " << (scan_ring ? "ring  " : "shared") << " read-ahead=" << (read_ahead ? "on " : "off")
+              << " pages/s=" << static_cast<uint64_t>(pages_scanned / seconds) << " misses=" << bpm.GetMissCount()
+              << " read ahead=" << bpm.GetReadAheadCount() << std::endl;
+    EXPECT_EQ(num_pages, pages_scanned);
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolBenchmark, RandomFetchBufferedVersusDirectIO) {
+  const std::string db_name = "bpm_bench.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 4096;
+  const int num_fetches = 20000;
+  // the number of pages of a file that sit in the kernel page cache
+  auto cached_pages = [](const std::string &file_name) {
+    FILE *file = fopen(file_name.c_str(), "r");
+    fseek(file, 0, SEEK_END);
+    size_t size = ftell(file);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileno(file), 0);
+    std::vector<unsigned char> residency((size + getpagesize() - 1) / getpagesize());
+    mincore(map, size, residency.data());
+    munmap(map, size);
+    fclose(file);
+    return std::count_if(residency.begin(), residency.end(), [](unsigned char page) { return page & 1; });
+  };
+
+  for (bool direct_io : {false, true}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name, direct_io);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData(), &page_id, sizeof(page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    bpm->FlushAllPages();
+    // the data set is 16 times the pool, so almost every fetch misses
+    std::minstd_rand rng(5);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_fetches; i++) {
+      page_id_t page_id = rng() % num_pages;
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, memcmp(page->GetData(), &page_id, sizeof(page_id)));
+      bpm->UnpinPage(page_id, false);
+    }
+    double seconds = SecondsSince(start);
+    std::cout << "[bench] " << (disk_manager->IsDirectIO() ? "direct  " : "buffered") << " io"
+              << " fetch/s=" << static_cast<uint64_t>(num_fetches / seconds) << " pool pages=" << buffer_pool_size
+              << " page cache pages=" << cached_pages(db_name) << std::endl;
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
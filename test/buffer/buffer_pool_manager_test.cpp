@@ -1,8 +1,13 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -72,3 +77,457 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   delete bpm;
   delete disk_manager;
 }
+
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "bpm_concurrent_test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_shards = 4;
+  const int num_pages = 256;
+  const int num_threads = 4;
+  const int rounds = 2000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_shards);
+  ASSERT_EQ(num_shards, bpm->GetShardCount());
+
+  // Scenario: every page stores its own id, so a reader can tell whether it got the right content.
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: several threads fetch random pages at the same time, much more pages than frames.
+  std::atomic<int> errors{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::default_random_engine rng(t);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < rounds; i++) {
+        page_id_t page_id = dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          errors++;
+          continue;
+        }
+        page_id_t stored;
+        memcpy(&stored, page->GetData(), sizeof(stored));
+        if (stored != page_id || page->GetPageId() != page_id) {
+          errors++;
+        }
+        bpm->UnpinPage(page_id, i % 7 == 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, errors.load());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, NewPageFullShardTest) {
+  const std::string db_name = "bpm_full_shard_test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_shards = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_shards);
+
+  // Scenario: every frame of shard 0 holds a pinned page, the other shards have room.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_EQ(i, page_id);
+    if (page_id % num_shards != 0) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  // the next page id maps to shard 0, it is skipped and freed again
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < 2 * (num_shards - 1); i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_NE(0, page_id % num_shards);
+    pinned.push_back(page_id);
+  }
+  EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+
+  // Scenario: every shard is full, no page is created and no page id stays allocated.
+  page_id_t page_id = INVALID_PAGE_ID;
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id);
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size * 3); i++) {
+    bool allocated = i < static_cast<page_id_t>(buffer_pool_size) ||
+                     std::find(pinned.begin(), pinned.end(), i) != pinned.end();
+    EXPECT_EQ(!allocated, bpm->IsPageFree(i));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i += num_shards) {
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+  for (page_id_t i : pinned) {
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const std::string db_name = "bpm_policy_test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 50;
+
+  for (ReplacerType replacer_type : {ReplacerType::LRU, ReplacerType::LRUK, ReplacerType::CLOCK}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, replacer_type);
+
+    // Scenario: write more pages than there are frames, so every policy has to evict dirty pages.
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData(), &page_id, sizeof(page_id));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: every page reads back with the content it was written with.
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      page_id_t stored;
+      memcpy(&stored, page->GetData(), sizeof(stored));
+      EXPECT_EQ(page_id, stored);
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: pinning every frame leaves no victim for any policy.
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(buffer_pool_size));
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ScanRingTest) {
+  const std::string db_name = "bpm_ring_test.db";
+  const size_t buffer_pool_size = 20;
+  const int num_hot_pages = 10;
+  const int num_scan_pages = 100;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_hot_pages + num_scan_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  {
+    // Scenario: a scan through a ring of four frames reads every page, holding the current and the next page.
+    BufferAccessStrategy strategy(bpm, 4);
+    Page *prev = nullptr;
+    for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; page_id++) {
+      auto *page = bpm->FetchPage(page_id, &strategy);
+      ASSERT_NE(nullptr, page);
+      page_id_t stored;
+      memcpy(&stored, page->GetData(), sizeof(stored));
+      EXPECT_EQ(page_id, stored);
+      if (prev != nullptr) {
+        ASSERT_TRUE(bpm->UnpinPage(prev->GetPageId(), false));
+      }
+      prev = page;
+    }
+    ASSERT_TRUE(bpm->UnpinPage(prev->GetPageId(), false));
+
+    // Scenario: the hot pages were not evicted by the scan.
+    uint64_t hits_before = bpm->GetHitCount();
+    for (page_id_t page_id = 0; page_id < num_hot_pages; page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    EXPECT_EQ(num_hot_pages, bpm->GetHitCount() - hits_before);
+
+    // Scenario: deleting a page that sits in a ring frame takes the frame out of the ring.
+    page_id_t last_page_id = num_hot_pages + num_scan_pages - 1;
+    EXPECT_TRUE(bpm->DeletePage(last_page_id));
+    EXPECT_NE(nullptr, bpm->FetchPage(num_hot_pages, &strategy));
+    EXPECT_TRUE(bpm->UnpinPage(num_hot_pages, false));
+  }
+
+  // Scenario: once the strategy is gone, all frames can be pinned again.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const std::string db_name = "bpm_cleaner_test.db";
+  const size_t buffer_pool_size = 32;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  bpm->StartPageCleaner(0.0, 0.25, 1);
+
+  // Scenario: fill the pool with dirty pages and let the cleaner write all of them back.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetCleanerWriteCount() < buffer_pool_size && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetCleanerWriteCount());
+
+  // Scenario: with the cleaner stopped, replacing the pool only finds clean victims.
+  bpm->StopPageCleaner();
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+
+  // Scenario: the pages written by the cleaner read back intact, and each one evicts a dirty page synchronously.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page_id_t stored;
+    memcpy(&stored, page->GetData(), sizeof(stored));
+    EXPECT_EQ(page_id, stored);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetForegroundWriteCount());
+  EXPECT_EQ(buffer_pool_size, bpm->GetCleanerWriteCount());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+/** Chains used by the read-ahead tests store the id of the next page at the start of each page. */
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "bpm_flush_test.db";
+  const size_t buffer_pool_size = 100;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    // leave a few pages pinned, they are written back all the same
+    if (i % 10 != 0) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  bpm->FlushAllPages();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    char data[PAGE_SIZE];
+    disk_manager->ReadPage(page_id, data);
+    page_id_t stored;
+    memcpy(&stored, data, sizeof(stored));
+    EXPECT_EQ(page_id, stored);
+    if (page_id % 10 == 0) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  // nothing is left dirty, so replacing the whole pool writes nothing
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+static page_id_t NextChainPageId(Page *page) {
+  page_id_t next_page_id;
+  memcpy(&next_page_id, page->GetData(), sizeof(next_page_id));
+  return next_page_id;
+}
+
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+  const std::string db_name = "bpm_read_ahead_test.db";
+  const size_t buffer_pool_size = 32;
+  const int num_pages = 24;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page_id_t next_page_id = page_id + 1 < num_pages ? page_id + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next_page_id, sizeof(next_page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+  auto wait_for_read_ahead = [bpm](uint64_t pages) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (bpm->GetReadAheadCount() < pages && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+
+  // Scenario: reading ahead 16 pages of a cold chain makes walking them miss free.
+  bpm->ReadAhead(0, 16, NextChainPageId);
+  wait_for_read_ahead(16);
+  EXPECT_EQ(16, bpm->GetReadAheadCount());
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, NextChainPageId(page));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetMissCount());
+
+  // Scenario: cached pages are skipped over and the chain ends at INVALID_PAGE_ID.
+  bpm->ReadAhead(8, 100, NextChainPageId);
+  wait_for_read_ahead(num_pages);
+  EXPECT_EQ(num_pages, bpm->GetReadAheadCount());
+
+  // Scenario: a strategy can be destroyed while reads for its ring are still queued.
+  for (int i = 0; i < 10; i++) {
+    BufferAccessStrategy strategy(bpm, 8);
+    bpm->ReadAhead(0, num_pages, NextChainPageId, &strategy);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: a page deleted after it was read ahead can be allocated again.
+  ASSERT_TRUE(bpm->DeletePage(num_pages - 1));
+  bpm->ReadAhead(num_pages - 1, 1, NextChainPageId);
+  page_id_t page_id;
+  auto *page = bpm->NewPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(num_pages - 1, page_id);
+  memcpy(page->GetData(), &page_id, sizeof(page_id));
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(page_id, NextChainPageId(page));
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ReadAheadWriteCountTest) {
+  const std::string db_name = "bpm_read_ahead_write_test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 2 * buffer_pool_size;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page_id_t next_page_id = page_id + 1 < num_pages ? page_id + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next_page_id, sizeof(next_page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: the pool is full of dirty pages, and reading a chain ahead writes them back. Those writes are the
+  // read-ahead thread's, not the foreground's.
+  for (page_id_t page_id = buffer_pool_size; page_id < num_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->ReadAhead(0, buffer_pool_size, NextChainPageId);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetReadAheadCount() < buffer_pool_size && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetReadAheadCount());
+  EXPECT_EQ(buffer_pool_size, bpm->GetReadAheadWriteCount());
+  EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const std::string db_name = "bpm_arena_test.db";
+  const size_t buffer_pool_size = 1024;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+
+  // Scenario: every frame is page aligned and the frames are laid out back to back.
+  std::vector<char *> frames;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    frames.push_back(page->GetData());
+  }
+  std::sort(frames.begin(), frames.end());
+  EXPECT_EQ(frames.front() + (buffer_pool_size - 1) * PAGE_SIZE, frames.back());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a page outside of a buffer pool gets aligned data of its own.
+  Page page;
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page.GetData()) % PAGE_SIZE);
+  EXPECT_EQ(INVALID_PAGE_ID, page.GetPageId());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
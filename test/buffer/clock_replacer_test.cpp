@@ -0,0 +1,100 @@
+#include "buffer/clock_replacer.h"
+
+#include <random>
+#include <unordered_set>
+
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(CLOCKReplacerTest, SampleTest) {
+  CLOCKReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+  clock_replacer.Unpin(4);
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // Scenario: get three victims from the clock.
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
+  clock_replacer.Unpin(4);
+
+  // Scenario: continue looking for victims. We expect these victims.
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+}
+
+TEST(CLOCKReplacerTest, MatchesLRUReplacerTest) {
+  const size_t num_frames = 64;
+  CLOCKReplacer clock_replacer(num_frames);
+  LRUReplacer lru_replacer(num_frames);
+  std::unordered_set<frame_id_t> evictable;
+  std::minstd_rand rng(42);
+
+  // Scenario: both replacers see the same random pin/unpin/victim sequence. They may pick different victims, but
+  // they must agree on how many frames are evictable and only ever return evictable frames. Each victim is pinned in
+  // the other replacer as well, so that both keep tracking the same set of frames.
+  for (int i = 0; i < 20000; i++) {
+    frame_id_t frame_id = rng() % num_frames;
+    switch (rng() % 3) {
+      case 0:
+        clock_replacer.Pin(frame_id);
+        lru_replacer.Pin(frame_id);
+        evictable.erase(frame_id);
+        break;
+      case 1:
+        clock_replacer.Unpin(frame_id);
+        lru_replacer.Unpin(frame_id);
+        evictable.insert(frame_id);
+        break;
+      default: {
+        // the first peeked frame is the one Victim picks
+        frame_id_t clock_next, lru_next;
+        size_t clock_peeked = clock_replacer.PeekVictims(&clock_next, 1);
+        size_t lru_peeked = lru_replacer.PeekVictims(&lru_next, 1);
+        frame_id_t clock_victim, lru_victim;
+        bool clock_found = clock_replacer.Victim(&clock_victim);
+        bool lru_found = lru_replacer.Victim(&lru_victim);
+        ASSERT_EQ(lru_found, clock_found);
+        ASSERT_EQ(clock_found ? 1 : 0, clock_peeked);
+        ASSERT_EQ(lru_found ? 1 : 0, lru_peeked);
+        if (clock_found) {
+          ASSERT_EQ(clock_next, clock_victim);
+          ASSERT_EQ(lru_next, lru_victim);
+          ASSERT_EQ(1, evictable.count(clock_victim));
+          ASSERT_EQ(1, evictable.count(lru_victim));
+          clock_replacer.Pin(lru_victim);
+          lru_replacer.Pin(clock_victim);
+          evictable.erase(clock_victim);
+          evictable.erase(lru_victim);
+        }
+        break;
+      }
+    }
+    ASSERT_EQ(lru_replacer.Size(), clock_replacer.Size());
+    ASSERT_EQ(evictable.size(), clock_replacer.Size());
+  }
+}
@@ -0,0 +1,62 @@
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Each of them has been referenced once.
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: reference 1 and 3 a second time. They now have a finite backward 2-distance.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: peeking reports the eviction order without removing anything.
+  int next[3];
+  ASSERT_EQ(3, lru_k_replacer.PeekVictims(next, 3));
+  EXPECT_EQ(2, next[0]);
+  EXPECT_EQ(3, next[1]);
+  EXPECT_EQ(4, next[2]);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames referenced only once are evicted first, oldest first.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(3);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: among frames with two references, the one whose second to last reference is oldest goes first.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: back to back references are correlated and count once, so 4 is still evicted before 5.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: a removed frame is no longer a candidate.
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Remove(6);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+}
@@ -1,5 +1,7 @@
 #include "catalog/catalog.h"
 
+#include <sys/stat.h>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "utils/utils.h"
@@ -129,3 +131,36 @@ TEST(CatalogTest, CatalogIndexTest) {
   }
   delete db_02;
 }
+
+TEST(CatalogTest, CatalogDropTableReclaimTest) {
+  const string db_name = "catalog_reclaim_test.db";
+  auto db_01 = new DBStorageEngine(db_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  char name[64];
+  memset(name, 'n', sizeof(name));
+  for (int i = 0; i < 5000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  db_01->bpm_->FlushAllPages();
+  struct stat before;
+  ASSERT_EQ(0, stat(db_01->db_file_name_.c_str(), &before));
+  // dropping the table gives its pages back, and the file ends after the catalog's pages again
+  ASSERT_EQ(DB_SUCCESS, catalog_01->DropTable("table-1"));
+  struct stat after;
+  ASSERT_EQ(0, stat(db_01->db_file_name_.c_str(), &after));
+  EXPECT_LT(after.st_size, before.st_size / 10);
+  EXPECT_LT(after.st_blocks, before.st_blocks / 10);
+  delete db_01;
+  auto db_02 = new DBStorageEngine(db_name, false);
+  TableInfo *table_info_02 = nullptr;
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, db_02->catalog_mgr_->GetTable("table-1", table_info_02));
+  delete db_02;
+}
@@ -1,6 +1,10 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
@@ -8,6 +12,18 @@
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
 
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+// Count the calls to malloc, which operator new goes through as well, to report the allocations of a query.
+#define COUNT_MALLOC_CALLS
+extern "C" void *__libc_malloc(size_t size);
+static std::atomic<uint64_t> malloc_calls{0};
+
+extern "C" void *malloc(size_t size) {
+  malloc_calls.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+#endif
+
 // SELECT id FROM table-1 WHERE id < 500
 TEST_F(ExecutorTest, SimpleSeqScanTest) {
   // Construct query plan
@@ -158,3 +174,110 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// INSERT INTO table-1 VALUES (1000, "bulk", 1.5), (1001, "bulk", 1.5), ...;
+TEST_F(ExecutorTest, BulkInsertTest) {
+  // Create a values plan node with enough rows for the insert to append them
+  const int num_rows = 2 * DEFAULT_BULK_INSERT_ROWS;
+  std::vector<std::vector<AbstractExpressionRef>> raw_values;
+  for (int i = 0; i < num_rows; i++) {
+    raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, 1000 + i)),
+                          MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("bulk"), 4, false)),
+                          MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(1.5)))});
+  }
+  auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+
+  // Create insert plan node
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+
+  // Execute insert plan, one result row per inserted row
+  std::vector<Row> result_set{};
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), num_rows);
+  result_set.clear();
+
+  // SELECT * FROM table-1 where id >= 1000;
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto const1000 = MakeConstantValueExpression(Field(kTypeInt, 1000));
+  auto predicate = MakeComparisonExpression(col_a, const1000, ">=");
+  auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+  GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // The appended rows come last, in order
+  ASSERT_EQ(result_set.size(), num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    ASSERT_TRUE(result_set[i].GetField(0)->CompareEquals(Field(kTypeInt, 1000 + i)));
+    ASSERT_TRUE(result_set[i].GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("bulk"), 4, false)));
+  }
+  ASSERT_TRUE(GetExecutorContext()->GetBufferPoolManager()->CheckAllUnpinned());
+}
+
+// DELETE FROM table-1 WHERE id < 900;
+TEST_F(ExecutorTest, DeleteVacuumTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto const900 = MakeConstantValueExpression(Field(kTypeInt, 900));
+  auto predicate = MakeComparisonExpression(col_id, const900, "<");
+  auto out_schema = MakeOutputSchema({{"id", col_id}});
+  auto scan_plan = std::make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+  auto delete_plan = std::make_shared<DeletePlanNode>(out_schema, scan_plan, table_info->GetTableName());
+
+  // The statement removes the rows it deleted once it ends
+  std::vector<Row> result_set;
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(delete_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), 900);
+  ASSERT_FALSE(table_info->GetTableHeap()->NeedsVacuum());
+  ASSERT_EQ(0, table_info->GetTableHeap()->Vacuum().tuples_removed_);
+
+  // SELECT id FROM table-1; only the rows that were kept remain
+  result_set.clear();
+  auto all_plan = std::make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), nullptr);
+  GetExecutionEngine()->ExecutePlan(all_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (const auto &row : result_set) {
+    ASSERT_FALSE(row.GetField(0)->CompareLessThan(Field(kTypeInt, 900)));
+  }
+}
+
+// SELECT * FROM table-1 WHERE id < 0; and SELECT * FROM table-1;
+TEST_F(ExecutorTest, AllocationsPerScannedRowBenchmark) {
+#ifndef COUNT_MALLOC_CALLS
+  GTEST_SKIP() << "malloc calls are only counted with glibc and without sanitizers";
+#else
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const int num_rows = 20000;
+  char name[] = "allocations per scanned row";
+  for (int i = 1000; i < num_rows; i++) {
+    Fields fields{Field(kTypeInt, i), Field(kTypeChar, name, i % sizeof(name), false), Field(kTypeFloat, 1.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+  }
+  const Schema *schema = table_info->GetSchema();
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto predicate = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 0)), "<");
+  auto filtered_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+  auto all_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), nullptr);
+
+  double filtered_per_row = 0, unfiltered_per_row = 0;
+  for (auto &[label, plan, expected] : {std::make_tuple("filtered", filtered_plan, 0),
+                                        std::make_tuple("unfiltered", all_plan, num_rows)}) {
+    std::vector<Row> result_set;
+    uint64_t before = malloc_calls.load();
+    ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext()));
+    double per_row = static_cast<double>(malloc_calls.load() - before) / num_rows;
+    ASSERT_EQ(expected, result_set.size());
+    std::cout << "[bench] scan " << label << " rows=" << num_rows << " results=" << result_set.size()
+              << " mallocs per scanned row=" << std::fixed << std::setprecision(3) << per_row << std::endl;
+    (expected == 0 ? filtered_per_row : unfiltered_per_row) = per_row;
+  }
+  // the rows a scan reads are deserialized into memory it reuses, a result row only allocates its field pointers
+  ASSERT_LT(filtered_per_row, 0.05);
+  ASSERT_LT(unfiltered_per_row, 1.1);
+#endif
+}
@@ -2,13 +2,17 @@
 #define MINISQL_UTILS_H
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <random>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "record/field.h"
 #include "storage/disk_manager.h"
 
+using Fields = std::vector<Field>;
+
 template <typename T>
 void ShuffleArray(std::vector<T> &array) {
   std::random_device rd;
@@ -16,6 +20,11 @@ void ShuffleArray(std::vector<T> &array) {
   std::shuffle(array.begin(), array.end(), rng);
 }
 
+/** @return the seconds passed since start, for the benchmarks' timings */
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 class RandomUtils {
  public:
   static void RandomString(char *buf, size_t len) {
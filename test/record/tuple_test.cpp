@@ -1,10 +1,16 @@
 #include <cstring>
+#include <map>
+#include <random>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "page/table_page.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 #include "common/heap.h"
 
@@ -101,3 +107,342 @@ TEST(TupleTest, RowTest) {
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
 }
+
+TEST(TupleTest, ArenaMemHeapTest) {
+  ArenaMemHeap heap(64);
+  // allocations are aligned, do not overlap and outgrow the first chunk
+  std::vector<char *> bufs;
+  for (uint32_t i = 0; i < 100; i++) {
+    auto *buf = static_cast<char *>(heap.Allocate(i % 13));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(buf) % alignof(std::max_align_t));
+    memset(buf, static_cast<int>(i), i % 13);
+    bufs.push_back(buf);
+  }
+  for (uint32_t i = 0; i < 100; i++) {
+    for (uint32_t j = 0; j < i % 13; j++) {
+      ASSERT_EQ(static_cast<char>(i), bufs[i][j]);
+    }
+  }
+  // an allocation larger than a chunk gets its own, the current chunk is still used after it
+  auto *large = static_cast<char *>(heap.Allocate(3 * ArenaMemHeap::MAX_CHUNK_SIZE));
+  memset(large, 1, 3 * ArenaMemHeap::MAX_CHUNK_SIZE);
+  auto *small = static_cast<char *>(heap.Allocate(8));
+  ASSERT_TRUE(small < large || small >= large + 3 * ArenaMemHeap::MAX_CHUNK_SIZE);
+  // after a reset the memory of the current chunk is handed out again
+  heap.Reset();
+  char *first = static_cast<char *>(heap.Allocate(16));
+  heap.Reset();
+  ASSERT_EQ(first, heap.Allocate(16));
+
+  // the fields of a row live in its own heap, or in the one it is given, and survive a copy of the row
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeFloat, 19.99f), Field(TypeId::kTypeChar)};
+  ArenaMemHeap rows_heap;
+  Row copy;
+  {
+    Row row(fields);
+    Row shared(row, &rows_heap);
+    ASSERT_NE(row.GetField(1)->GetData(), fields[1].GetData());
+    ASSERT_NE(shared.GetField(1)->GetData(), row.GetField(1)->GetData());
+    copy = shared;
+  }
+  ASSERT_EQ(fields.size(), copy.GetFieldCount());
+  for (size_t i = 0; i < fields.size(); i++) {
+    ASSERT_EQ(fields[i].IsNull(), copy.GetField(i)->IsNull());
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, copy.GetField(i)->CompareEquals(fields[i]));
+    }
+  }
+  // copying a row into another reuses the memory of the fields it had
+  Row source(fields);
+  copy = source;
+  const Field *field = copy.GetField(0);
+  copy = source;
+  ASSERT_EQ(field, copy.GetField(0));
+}
+
+TEST(TupleTest, FieldAndRowMoveTest) {
+  char long_chars[] = "longer than the inline chars of a field";
+  ASSERT_GT(strlen(long_chars), Field::INLINE_CHARS_SIZE);
+  // a short managed CHAR is kept inline, copies and moves keep their own chars
+  Field short_field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), true);
+  Field short_copy(short_field);
+  ASSERT_NE(short_field.GetData(), short_copy.GetData());
+  ASSERT_TRUE(short_copy.GetData() >= reinterpret_cast<char *>(&short_copy) &&
+              short_copy.GetData() < reinterpret_cast<char *>(&short_copy + 1));
+  Field short_moved(std::move(short_copy));
+  ASSERT_EQ(CmpBool::kTrue, short_moved.CompareEquals(short_field));
+  // a long one is allocated, a move takes over its chars and leaves the field it moved from null
+  Field long_field(TypeId::kTypeChar, long_chars, strlen(long_chars), true);
+  Field long_copy(long_field);
+  ASSERT_NE(long_field.GetData(), long_copy.GetData());
+  const char *chars = long_copy.GetData();
+  Field long_moved(std::move(long_copy));
+  ASSERT_EQ(chars, long_moved.GetData());
+  ASSERT_TRUE(long_copy.IsNull());
+  // assignment copies, and swaps on a move
+  Field assigned(TypeId::kTypeInt, 1);
+  assigned = long_field;
+  ASSERT_EQ(CmpBool::kTrue, assigned.CompareEquals(long_field));
+  ASSERT_NE(long_field.GetData(), assigned.GetData());
+  assigned = std::move(long_moved);
+  ASSERT_EQ(chars, assigned.GetData());
+  std::vector<Field> moved_fields;
+  for (int i = 0; i < 100; i++) {
+    moved_fields.emplace_back(TypeId::kTypeChar, long_chars, strlen(long_chars), true);
+  }
+  for (auto &field : moved_fields) {
+    ASSERT_EQ(CmpBool::kTrue, field.CompareEquals(long_field));
+  }
+
+  // a moved row keeps its fields where they are
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188), long_field, short_field};
+  Row row(fields);
+  const Field *first = row.GetField(0);
+  Row moved(std::move(row));
+  ASSERT_EQ(first, moved.GetField(0));
+  ASSERT_EQ(0, row.GetFieldCount());
+  Row assigned_row;
+  assigned_row = std::move(moved);
+  ASSERT_EQ(first, assigned_row.GetField(0));
+  for (size_t i = 0; i < fields.size(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, assigned_row.GetField(i)->CompareEquals(fields[i]));
+  }
+  // moving a row without fields in, like a scan does for every row, only clears the fields
+  RowId rid(1, 2);
+  assigned_row = Row(rid);
+  ASSERT_EQ(rid, assigned_row.GetRowId());
+  ASSERT_EQ(0, assigned_row.GetFieldCount());
+
+  // rows of a shared heap move by pointer, e.g. when a vector of them grows
+  ArenaMemHeap heap;
+  std::vector<Row> rows;
+  rows.emplace_back(Row(fields), &heap);
+  first = rows[0].GetField(0);
+  for (int i = 1; i < 100; i++) {
+    rows.emplace_back(rows[0], &heap);
+  }
+  ASSERT_EQ(first, rows[0].GetField(0));
+  for (auto &moved_row : rows) {
+    for (size_t i = 0; i < fields.size(); i++) {
+      ASSERT_EQ(CmpBool::kTrue, moved_row.GetField(i)->CompareEquals(fields[i]));
+    }
+  }
+}
+
+TEST(TupleTest, TablePageChurnTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char name[64];
+  memset(name, 'x', sizeof(name));
+  auto make_row = [&](int id, uint32_t len) {
+    std::vector<Field> fields = {Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, name, len, false)};
+    return Row(fields);
+  };
+  // the id and the name length of the tuple in each used slot
+  std::map<uint32_t, std::pair<int, uint32_t>> tuples;
+  auto check = [&]() {
+    for (auto &[slot, tuple] : tuples) {
+      Row row(RowId(0, slot));
+      ASSERT_TRUE(table_page.GetTuple(&row, schema.get(), nullptr, nullptr));
+      ASSERT_TRUE(row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, tuple.first)));
+      ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(TypeId::kTypeChar, name, tuple.second, false)));
+    }
+    size_t visited = 0;
+    RowId rid;
+    for (bool found = table_page.GetFirstTupleRid(&rid); found; found = table_page.GetNextTupleRid(rid, &rid)) {
+      ASSERT_EQ(1, tuples.count(rid.GetSlotNum()));
+      visited++;
+    }
+    ASSERT_EQ(tuples.size(), visited);
+  };
+
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  std::mt19937 rng(7);
+  for (int i = 0; i < 20000; i++) {
+    uint32_t len = rng() % sizeof(name);
+    int op = rng() % 3;
+    if (op == 0 || tuples.empty()) {
+      // insert: a slot that was free before
+      Row row = make_row(i, len);
+      if (table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) {
+        ASSERT_EQ(0, tuples.count(row.GetRowId().GetSlotNum()));
+        tuples[row.GetRowId().GetSlotNum()] = {i, len};
+      } else {
+        ASSERT_LT(table_page.GetFreeSpaceRemaining(), row.GetSerializedSize(schema.get()) + 8);
+      }
+      continue;
+    }
+    auto it = tuples.begin();
+    std::advance(it, rng() % tuples.size());
+    RowId rid(0, it->first);
+    if (op == 1) {
+      // delete, applied right away or by a vacuum
+      ASSERT_TRUE(table_page.MarkDelete(rid, nullptr, nullptr, nullptr));
+      if (rng() % 8 == 0) {
+        ASSERT_EQ(1, table_page.Vacuum());
+      } else {
+        table_page.ApplyDelete(rid, nullptr, nullptr);
+      }
+      tuples.erase(it);
+    } else {
+      // update, growing or shrinking the tuple
+      Row new_row = make_row(i, len);
+      Row old_row(rid);
+      int state;
+      if (table_page.UpdateTuple(new_row, &old_row, schema.get(), nullptr, nullptr, nullptr, state)) {
+        ASSERT_TRUE(old_row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, it->second.first)));
+        it->second = {i, len};
+      } else {
+        ASSERT_EQ(3, state);
+      }
+    }
+    if (i % 500 == 0) {
+      check();
+    }
+  }
+  check();
+
+  // a page whose tuples are all deleted is empty again
+  while (!tuples.empty()) {
+    RowId rid(0, tuples.begin()->first);
+    ASSERT_TRUE(table_page.MarkDelete(rid, nullptr, nullptr, nullptr));
+    table_page.ApplyDelete(rid, nullptr, nullptr);
+    tuples.erase(tuples.begin());
+  }
+  ASSERT_TRUE(table_page.IsEmpty());
+  ASSERT_EQ(PAGE_SIZE - 24, table_page.GetFreeSpaceRemaining());
+
+  // a page written before pages kept a free slot list: no list, and a free slot of size 0 in the middle
+  for (int i = 0; i < 3; i++) {
+    Row row = make_row(i, 8);
+    ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+    tuples[row.GetRowId().GetSlotNum()] = {i, 8};
+  }
+  ASSERT_TRUE(table_page.MarkDelete(RowId(0, 1), nullptr, nullptr, nullptr));
+  ASSERT_EQ(1, table_page.Vacuum());
+  tuples.erase(1);
+  memset(table_page.GetData() + 18, 0, 2);
+  memset(table_page.GetData() + 24 + 8, 0, 8);
+  check();
+  Row row = make_row(3, 8);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_EQ(RowId(0, 1), row.GetRowId());
+  tuples[1] = {3, 8};
+  check();
+}
+
+/** Serialize a row in format v1, the format written before v2. */
+static std::vector<char> SerializeV1(Row &row) {
+  std::vector<char> buffer(sizeof(uint32_t) + Row::GetNullBitmapSize(row.GetFieldCount()));
+  MACH_WRITE_UINT32(buffer.data(), row.GetFieldCount());
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    Field *field = row.GetField(i);
+    if (field->IsNull()) {
+      continue;
+    }
+    buffer[sizeof(uint32_t) + i / 8] |= 0x80 >> (i % 8);
+    size_t offset = buffer.size();
+    buffer.resize(offset + field->GetSerializedSize());
+    field->SerializeTo(buffer.data() + offset);
+  }
+  return buffer;
+}
+
+TEST(TupleTest, RowViewTest) {
+  // ten columns, so that the null bitmap takes two bytes
+  std::vector<Column *> columns;
+  for (uint32_t i = 0; i < 10; i++) {
+    TypeId type = i % 3 == 0 ? TypeId::kTypeInt : (i % 3 == 1 ? TypeId::kTypeChar : TypeId::kTypeFloat);
+    std::string name = "c" + std::to_string(i);
+    columns.push_back(type == TypeId::kTypeChar ? new Column(name, type, 16, i, true, false)
+                                                : new Column(name, type, i, true, false));
+  }
+  Schema schema(columns);
+  const char *strings[] = {"", "a", "ab", "abc", "b", "hello", "world!"};
+  std::mt19937 rng(11);
+  auto random_field = [&](TypeId type) {
+    if (rng() % 5 == 0) {
+      return Field(type);
+    }
+    if (type == TypeId::kTypeInt) {
+      return Field(type, static_cast<int32_t>(rng() % 7) - 3);
+    }
+    if (type == TypeId::kTypeFloat) {
+      return Field(type, static_cast<float>(rng() % 7) / 2);
+    }
+    const char *str = strings[rng() % 7];
+    return Field(type, const_cast<char *>(str), strlen(str), true);
+  };
+
+  const int row_nums = 100;
+  std::vector<std::unique_ptr<Row>> rows;
+  std::vector<std::vector<char>> buffers;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields;
+    for (auto column : columns) {
+      fields.push_back(random_field(column->GetType()));
+    }
+    rows.push_back(std::make_unique<Row>(fields));
+    // every other row is written in format v1, which must still be read
+    if (i % 2 == 1) {
+      buffers.push_back(SerializeV1(*rows.back()));
+      continue;
+    }
+    buffers.emplace_back(rows.back()->GetSerializedSize(&schema));
+    ASSERT_EQ(buffers.back().size(), rows.back()->SerializeTo(buffers.back().data(), &schema));
+    ASSERT_EQ(ROW_FORMAT_V2, MACH_READ_FROM(uint16_t, buffers.back().data()));
+  }
+
+  for (int i = 0; i < row_nums; i++) {
+    Row row(INVALID_ROWID);
+    ASSERT_EQ(buffers[i].size(), row.DeserializeFrom(buffers[i].data(), &schema));
+    for (uint32_t column = 0; column < columns.size(); column++) {
+      Field *field = rows[i]->GetField(column);
+      ASSERT_EQ(field->IsNull(), row.GetField(column)->IsNull());
+      ASSERT_TRUE(field->IsNull() || row.GetField(column)->CompareEquals(*field) == CmpBool::kTrue);
+    }
+
+    RowView view(buffers[i].data(), &schema);
+    ASSERT_EQ(columns.size(), view.GetFieldCount());
+    // read the columns out of order, backwards as well
+    for (uint32_t k = 0; k < 2 * columns.size(); k++) {
+      uint32_t column = rng() % columns.size();
+      Field *field = rows[i]->GetField(column);
+      ASSERT_EQ(field->IsNull(), view.IsNull(column));
+      if (field->IsNull()) {
+        ASSERT_TRUE(view.GetField(column).IsNull());
+        continue;
+      }
+      ASSERT_EQ(CmpBool::kTrue, view.GetField(column).CompareEquals(*field));
+      if (field->GetTypeId() == TypeId::kTypeChar) {
+        ASSERT_EQ(std::string_view(field->GetData(), field->GetLength()), view.GetChars(column));
+      }
+    }
+    // columns compare like their fields, nulls compare equal; the other row is in the other format
+    RowView other(buffers[(i + 1) % row_nums].data(), &schema);
+    for (uint32_t column = 0; column < columns.size(); column++) {
+      Field *lhs = rows[i]->GetField(column);
+      Field *rhs = rows[(i + 1) % row_nums]->GetField(column);
+      int expected = lhs->CompareLessThan(*rhs) == CmpBool::kTrue      ? -1
+                     : lhs->CompareGreaterThan(*rhs) == CmpBool::kTrue ? 1
+                                                                       : 0;
+      int cmp = view.CompareColumn(column, other);
+      ASSERT_EQ(expected, cmp < 0 ? -1 : (cmp > 0 ? 1 : 0));
+    }
+    // a predicate gives the same result on the view as on the row
+    for (uint32_t column : {0U, 1U}) {
+      auto col = std::make_shared<ColumnValueExpression>(0, column, columns[column]->GetType());
+      Field constant = random_field(columns[column]->GetType());
+      auto cons = std::make_shared<ConstantValueExpression>(constant);
+      for (const char *op : {"=", "<", ">=", "is"}) {
+        ComparisonExpression predicate(col, cons, op);
+        ASSERT_EQ(CmpBool::kTrue, predicate.Evaluate(rows[i].get()).CompareEquals(predicate.Evaluate(view)));
+      }
+    }
+  }
+}
+
@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/async_io.h"
+#include "storage/disk_manager.h"
+#include "utils/utils.h"
+
+/**
+ * Disk manager micro benchmarks. The file is small enough to stay in the OS page cache, so they measure the cost of
+ * the I/O path itself rather than the device.
+ */
+
+TEST(DiskManagerBenchmark, RandomPageIOPS) {
+  const std::string db_name = "disk_bench.db";
+  const int num_pages = 4096;
+  const int num_ops = 40000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    disk_manager->WritePage(page_id, data);
+  }
+
+  for (bool write : {false, true}) {
+    for (int num_threads : {1, 4}) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          std::minstd_rand rng(t + 1);
+          char buf[PAGE_SIZE];
+          memset(buf, 'y', PAGE_SIZE);
+          for (int i = 0; i < num_ops / num_threads; i++) {
+            page_id_t page_id = rng() % num_pages;
+            if (write) {
+              disk_manager->WritePage(page_id, buf);
+            } else {
+              disk_manager->ReadPage(page_id, buf);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      double seconds = SecondsSince(start);
+      std::cout << "[bench] random " << (write ? "write" : "read ") << " threads=" << num_threads
+                << " IOPS=" << static_cast<uint64_t>(num_ops / seconds) << std::endl;
+    }
+  }
+
+  disk_manager->ReadPage(0, data);
+  EXPECT_TRUE(data[0] == 'x' || data[0] == 'y');
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerBenchmark, AsyncRandomReadIOPS) {
+  const std::string db_name = "disk_bench.db";
+  const int num_pages = 4096;
+  const int num_ops = 40000;
+  const size_t queue_depth = DEFAULT_IO_QUEUE_DEPTH;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    disk_manager->WritePage(page_id, data);
+  }
+
+  std::vector<char> buffers(queue_depth * PAGE_SIZE);
+  std::vector<AsyncIORequest> requests(queue_depth);
+  std::vector<AsyncIORequest *> batch(queue_depth);
+  for (AsyncIOType type : {AsyncIOType::THREAD_POOL, AsyncIOType::IO_URING}) {
+    AsyncIO *io = AsyncIO::Create(disk_manager, queue_depth, type);
+    std::minstd_rand rng(1);
+    auto start = std::chrono::steady_clock::now();
+    // keep the queue full: every completed read is replaced by the next one
+    for (size_t i = 0; i < queue_depth; i++) {
+      requests[i] = {false, static_cast<page_id_t>(rng() % num_pages), buffers.data() + i * PAGE_SIZE, 0, nullptr};
+      batch[i] = &requests[i];
+    }
+    int submitted = io->Submit(batch.data(), queue_depth);
+    int completed = 0;
+    while (completed < num_ops) {
+      size_t reaped = io->Reap(batch.data(), queue_depth, 1);
+      completed += reaped;
+      size_t refill = std::min<size_t>(reaped, std::max(0, num_ops - submitted));
+      for (size_t i = 0; i < refill; i++) {
+        batch[i]->page_id_ = rng() % num_pages;
+      }
+      submitted += io->Submit(batch.data(), refill);
+    }
+    double seconds = SecondsSince(start);
+    std::cout << "[bench] async random read " << (io->GetType() == AsyncIOType::IO_URING ? "io_uring   " : "thread pool")
+              << " depth=" << queue_depth << " IOPS=" << static_cast<uint64_t>(num_ops / seconds) << std::endl;
+    EXPECT_EQ(num_ops, completed);
+    delete io;
+  }
+
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerBenchmark, AllocateAndFreePages) {
+  const std::string db_name = "disk_bench.db";
+  const int num_pages = 3 * DiskManager::BITMAP_SIZE;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_manager->AllocatePage());
+  }
+  double seconds = SecondsSince(start);
+  std::cout << "[bench] allocate pages/s=" << static_cast<uint64_t>(num_pages / seconds) << std::endl;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_FALSE(disk_manager->IsPageFree(i));
+    disk_manager->DeAllocatePage(i);
+  }
+  seconds = SecondsSince(start);
+  std::cout << "[bench] check and free pages/s=" << static_cast<uint64_t>(num_pages / seconds) << std::endl;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
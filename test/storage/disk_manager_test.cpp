@@ -1,8 +1,36 @@
 #include "storage/disk_manager.h"
 
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <random>
 #include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "storage/async_io.h"
+#include "storage/page_compressor.h"
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+// Count the calls to pread and pwrite, to check which transfers are done synchronously.
+#define COUNT_IO_CALLS
+static std::atomic<uint64_t> pread_calls{0};
+static std::atomic<uint64_t> pwrite_calls{0};
+
+extern "C" ssize_t pread(int fd, void *buf, size_t count, off_t offset) {
+  static auto next = reinterpret_cast<ssize_t (*)(int, void *, size_t, off_t)>(dlsym(RTLD_NEXT, "pread"));
+  pread_calls++;
+  return next(fd, buf, count, offset);
+}
+
+extern "C" ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset) {
+  static auto next = reinterpret_cast<ssize_t (*)(int, const void *, size_t, off_t)>(dlsym(RTLD_NEXT, "pwrite"));
+  pwrite_calls++;
+  return next(fd, buf, count, offset);
+}
+#endif
 
 TEST(DiskManagerTest, BitMapPageTest) {
   const size_t size = 512;
@@ -58,3 +86,465 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
 }
+
+TEST(DiskManagerTest, AsyncIOTest) {
+  std::string db_name = "disk_async_test.db";
+  const int num_pages = 100;
+  const size_t queue_depth = 16;
+
+  for (AsyncIOType type : {AsyncIOType::AUTO, AsyncIOType::THREAD_POOL}) {
+    remove(db_name.c_str());
+    // direct I/O makes the unaligned test buffers go through the synchronous fallback
+    auto *disk_mgr = new DiskManager(db_name, type == AsyncIOType::AUTO);
+    AsyncIO *io = AsyncIO::Create(disk_mgr, queue_depth, type);
+    ASSERT_NE(AsyncIOType::AUTO, io->GetType());
+    if (type == AsyncIOType::THREAD_POOL) {
+      EXPECT_EQ(AsyncIOType::THREAD_POOL, io->GetType());
+    }
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<AsyncIORequest> requests(num_pages);
+    std::vector<AsyncIORequest *> batch(num_pages);
+    std::vector<AsyncIORequest *> completed(num_pages);
+    auto run_batch = [&]() {
+      size_t submitted = 0;
+      size_t reaped = 0;
+      while (reaped < batch.size()) {
+        size_t count = io->Submit(batch.data() + submitted, batch.size() - submitted);
+        EXPECT_LE(io->GetInFlight(), queue_depth);
+        submitted += count;
+        reaped += io->Reap(completed.data() + reaped, batch.size() - reaped, 1);
+      }
+      EXPECT_EQ(batch.size(), submitted);
+      EXPECT_EQ(0, io->GetInFlight());
+    };
+
+    // Scenario: a batch of writes lands in the file.
+    for (int i = 0; i < num_pages; i++) {
+      memset(pages[i].data(), 'a' + i % 26, PAGE_SIZE);
+      requests[i] = {true, i, pages[i].data(), -1, nullptr};
+      batch[i] = &requests[i];
+    }
+    run_batch();
+    char data[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+      EXPECT_EQ(0, completed[i]->result_);
+      disk_mgr->ReadPage(i, data);
+      EXPECT_EQ(0, memcmp(data, pages[i].data(), PAGE_SIZE));
+    }
+
+    // Scenario: a batch of reads, half of them past the end of the file, which yield zeroed pages.
+    for (int i = 0; i < num_pages; i++) {
+      memset(pages[i].data(), 'z', PAGE_SIZE);
+      page_id_t page_id = i % 2 == 0 ? i : num_pages + i;
+      requests[i] = {false, page_id, pages[i].data(), -1, nullptr};
+    }
+    run_batch();
+    for (int i = 0; i < num_pages; i++) {
+      EXPECT_EQ(0, requests[i].result_);
+      char expected = i % 2 == 0 ? static_cast<char>('a' + i % 26) : 0;
+      EXPECT_EQ(std::vector<char>(PAGE_SIZE, expected), pages[i]);
+    }
+
+    delete io;
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncDirectIOTest) {
+#ifndef COUNT_IO_CALLS
+  GTEST_SKIP() << "pread and pwrite calls are only counted with glibc and without sanitizers";
+#else
+  std::string db_name = "disk_async_direct_test.db";
+  remove(db_name.c_str());
+  const int num_pages = 16;
+  auto *disk_mgr = new DiskManager(db_name, true);
+  AsyncIO *io = AsyncIO::Create(disk_mgr, num_pages);
+  if (!disk_mgr->IsDirectIO() || io->GetType() != AsyncIOType::IO_URING) {
+    delete io;
+    delete disk_mgr;
+    remove(db_name.c_str());
+    GTEST_SKIP() << "needs direct I/O and io_uring";
+  }
+  auto *pages = static_cast<char *>(aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE));
+  std::vector<AsyncIORequest> requests(num_pages);
+  std::vector<AsyncIORequest *> batch(num_pages);
+  std::vector<AsyncIORequest *> completed(num_pages);
+  auto run_batch = [&](bool is_write) {
+    for (int i = 0; i < num_pages; i++) {
+      requests[i] = {is_write, i, pages + i * PAGE_SIZE, -1, nullptr};
+      batch[i] = &requests[i];
+    }
+    ASSERT_EQ(num_pages, io->Submit(batch.data(), num_pages));
+    size_t reaped = 0;
+    while (reaped < num_pages) {
+      reaped += io->Reap(completed.data() + reaped, num_pages - reaped, 1);
+    }
+    for (auto &request : requests) {
+      EXPECT_EQ(0, request.result_);
+    }
+  };
+
+  // the pages of aligned requests the kernel completed are not transferred again
+  for (int i = 0; i < num_pages; i++) {
+    memset(pages + i * PAGE_SIZE, 'a' + i, PAGE_SIZE);
+  }
+  uint64_t pwrites = pwrite_calls.load();
+  run_batch(true);
+  EXPECT_EQ(pwrites, pwrite_calls.load());
+  memset(pages, 0, num_pages * PAGE_SIZE);
+  uint64_t preads = pread_calls.load();
+  run_batch(false);
+  EXPECT_EQ(preads, pread_calls.load());
+  for (int i = 0; i < num_pages; i++) {
+    char *page = pages + i * PAGE_SIZE;
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'a' + i), std::vector<char>(page, page + PAGE_SIZE));
+  }
+  free(pages);
+  delete io;
+  delete disk_mgr;
+  remove(db_name.c_str());
+#endif
+}
+
+TEST(DiskManagerTest, DirectIOTest) {
+  std::string db_name = "disk_direct_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, true);
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(i, disk_mgr->AllocatePage());
+  }
+  // aligned like the buffer pool's frames, and deliberately misaligned
+  alignas(PAGE_SIZE) char aligned[PAGE_SIZE];
+  char unaligned_buf[PAGE_SIZE + 1];
+  char *unaligned = unaligned_buf + 1;
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    char *data = page_id % 2 == 0 ? aligned : unaligned;
+    memset(data, 'a' + page_id, PAGE_SIZE);
+    disk_mgr->WritePage(page_id, data);
+  }
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    char *data = page_id % 2 == 0 ? unaligned : aligned;
+    disk_mgr->ReadPage(page_id, data);
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'a' + page_id), std::vector<char>(data, data + PAGE_SIZE));
+  }
+  disk_mgr->ReadPage(100, aligned);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(aligned, aligned + PAGE_SIZE));
+  delete disk_mgr;
+
+  // the allocation state survives reopening the file in buffered mode
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_FALSE(disk_mgr->IsDirectIO());
+  EXPECT_FALSE(disk_mgr->IsPageFree(9));
+  EXPECT_TRUE(disk_mgr->IsPageFree(10));
+  disk_mgr->ReadPage(3, aligned);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'a' + 3), std::vector<char>(aligned, aligned + PAGE_SIZE));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, MetadataFlushTest) {
+  std::string db_name = "disk_meta_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE + 10; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  disk_mgr->DeAllocatePage(5);
+  // the allocations only live in memory until the metadata is flushed
+  auto *reader = new DiskManager(db_name);
+  EXPECT_TRUE(reader->IsPageFree(0));
+  EXPECT_EQ(0, reinterpret_cast<DiskFileMetaPage *>(reader->GetMetaData())->GetAllocatedPages());
+  delete reader;
+
+  disk_mgr->FlushMetadata();
+  reader = new DiskManager(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(reader->GetMetaData());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 9, meta_page->GetAllocatedPages());
+  EXPECT_EQ(2, meta_page->GetExtentNums());
+  EXPECT_EQ(10, meta_page->GetExtentUsedPage(1));
+  EXPECT_TRUE(reader->IsPageFree(5));
+  EXPECT_FALSE(reader->IsPageFree(DiskManager::BITMAP_SIZE + 9));
+  EXPECT_TRUE(reader->IsPageFree(DiskManager::BITMAP_SIZE + 10));
+  delete reader;
+
+  // the freed page is handed out again first, closing flushes as well and freeing a page twice counts it once
+  EXPECT_EQ(5, disk_mgr->AllocatePage());
+  disk_mgr->DeAllocatePage(6);
+  disk_mgr->DeAllocatePage(6);
+  delete disk_mgr;
+  reader = new DiskManager(db_name);
+  meta_page = reinterpret_cast<DiskFileMetaPage *>(reader->GetMetaData());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 9, meta_page->GetAllocatedPages());
+  EXPECT_TRUE(reader->IsPageFree(6));
+  EXPECT_FALSE(reader->IsPageFree(5));
+  delete reader;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AllocationRunTest) {
+  std::string db_name = "disk_run_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  const page_id_t run_pages = DEFAULT_ALLOCATION_RUN_PAGES;
+  EXPECT_EQ(0, disk_mgr->AllocatePage());
+
+  // Scenario: two owners allocating in turns each get a contiguous run, other allocations go around both runs.
+  AllocationRun run_a;
+  AllocationRun run_b;
+  for (page_id_t i = 0; i < run_pages; i++) {
+    EXPECT_EQ(run_pages + i, disk_mgr->AllocatePage(&run_a));
+    EXPECT_EQ(2 * run_pages + i, disk_mgr->AllocatePage(&run_b));
+    if (i < 10) {
+      EXPECT_EQ(i + 1, disk_mgr->AllocatePage());
+    }
+  }
+  // a used up run moves on to the next free run
+  EXPECT_EQ(3 * run_pages, disk_mgr->AllocatePage(&run_a));
+  EXPECT_FALSE(disk_mgr->IsPageFree(3 * run_pages + 1));
+
+  // Scenario: pages reserved but not handed out are free on disk.
+  disk_mgr->FlushMetadata();
+  auto *reader = new DiskManager(db_name);
+  EXPECT_FALSE(reader->IsPageFree(3 * run_pages));
+  EXPECT_TRUE(reader->IsPageFree(3 * run_pages + 1));
+  EXPECT_EQ(11 + 2 * run_pages + 1, reinterpret_cast<DiskFileMetaPage *>(reader->GetMetaData())->GetAllocatedPages());
+  delete reader;
+
+  // Scenario: a released run gives its pages back at once.
+  disk_mgr->ReleaseRun(&run_a);
+  for (page_id_t page_id = 3 * run_pages + 1; page_id < 4 * run_pages; page_id++) {
+    EXPECT_TRUE(disk_mgr->IsPageFree(page_id));
+  }
+
+  // Scenario: with runs turned off, a run allocates like AllocatePage and reserves nothing.
+  disk_mgr->SetAllocationRunPages(0);
+  AllocationRun run_c;
+  page_id_t page_id = disk_mgr->AllocatePage(&run_c);
+  EXPECT_FALSE(disk_mgr->IsPageFree(page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, run_c.next_);
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, MetadataUpgradeTest) {
+  if (PAGE_SIZE != DiskFileMetaPage::V1_PAGE_SIZE) {
+    GTEST_SKIP() << "version 1 files only exist with " << DiskFileMetaPage::V1_PAGE_SIZE << " byte pages";
+  }
+  std::string db_name = "disk_upgrade_test.db";
+  remove(db_name.c_str());
+  const uint32_t extents = DiskFileMetaPage::V1_MAX_EXTENTS;
+  const uint32_t pages_per_extent = DiskManager::BITMAP_SIZE;
+  // a version 1 file with every extent full: two counts, then the used pages of each extent
+  FILE *file = fopen(db_name.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  std::vector<uint32_t> page(PAGE_SIZE / sizeof(uint32_t), pages_per_extent);
+  page[0] = extents * pages_per_extent;
+  page[1] = extents;
+  fwrite(page.data(), PAGE_SIZE, 1, file);
+  // only the bitmaps of the extents whose counts move into an overflow page are read, they must be full as well
+  std::vector<uint32_t> bitmap(PAGE_SIZE / sizeof(uint32_t), UINT32_MAX);
+  bitmap[0] = pages_per_extent;
+  for (uint32_t extent_id = DiskFileMetaPage::MAX_EXTENTS; extent_id < extents; extent_id++) {
+    fseek(file, static_cast<long>(extent_id) * (pages_per_extent + 1) * PAGE_SIZE + PAGE_SIZE, SEEK_SET);
+    fwrite(bitmap.data(), PAGE_SIZE, 1, file);
+  }
+  fclose(file);
+
+  auto *disk_mgr = new DiskManager(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_TRUE(meta_page->HasHeader());
+  for (uint32_t extent_id = 0; extent_id < extents; extent_id++) {
+    ASSERT_EQ(pages_per_extent, disk_mgr->GetExtentUsedPages(extent_id));
+  }
+  // the version 1 meta page had no room for this extent, the overflow page took its first page
+  page_id_t page_id = disk_mgr->AllocatePage();
+  EXPECT_EQ(extents * pages_per_extent + 1, page_id);
+  EXPECT_EQ(2, disk_mgr->GetExtentUsedPages(extents));
+  EXPECT_EQ(extents * pages_per_extent + 2, meta_page->GetAllocatedPages());
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(extents * pages_per_extent + 2, meta_page->GetAllocatedPages());
+  EXPECT_EQ(pages_per_extent, disk_mgr->GetExtentUsedPages(extents - 1));
+  EXPECT_EQ(2, disk_mgr->GetExtentUsedPages(extents));
+  EXPECT_FALSE(disk_mgr->IsPageFree(page_id));
+  EXPECT_EQ(page_id + 1, disk_mgr->AllocatePage());
+  disk_mgr->DeAllocatePage(page_id);
+  EXPECT_EQ(2, disk_mgr->GetExtentUsedPages(extents));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageSizeMismatchTest) {
+  std::string db_name = "disk_page_size_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(PAGE_SIZE, meta_page->page_size_);
+  EXPECT_EQ(0, disk_mgr->AllocatePage());
+  delete disk_mgr;
+
+  // a file written by a build with another page size is refused
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  uint32_t other_page_size = PAGE_SIZE * 2;
+  fseek(file, offsetof(DiskFileMetaPage, page_size_), SEEK_SET);
+  fwrite(&other_page_size, sizeof(other_page_size), 1, file);
+  fclose(file);
+  EXPECT_THROW(DiskManager disk_manager(db_name), std::exception);
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageCompressorTest) {
+  std::mt19937 random(11);
+  char page[PAGE_SIZE];
+  char compressed[PAGE_SIZE];
+  char decompressed[PAGE_SIZE];
+  // zeros, a short repeated pattern, text with some variation and random bytes
+  for (int kind = 0; kind < 4; kind++) {
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+      switch (kind) {
+        case 0: page[i] = 0; break;
+        case 1: page[i] = "abc"[i % 3]; break;
+        case 2: page[i] = i % 64 < 48 ? 'x' : static_cast<char>('0' + random() % 10); break;
+        default: page[i] = static_cast<char>(random());
+      }
+    }
+    size_t size = PageCompressor::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+    if (kind == 3) {
+      // random bytes do not fit into a page once compressed
+      EXPECT_EQ(0, size);
+      continue;
+    }
+    ASSERT_GT(size, 0);
+    EXPECT_LT(size, PAGE_SIZE / 2);
+    ASSERT_TRUE(PageCompressor::Decompress(compressed, size, decompressed, PAGE_SIZE));
+    EXPECT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+    // input cut short is detected
+    EXPECT_FALSE(PageCompressor::Decompress(compressed, size / 2, decompressed, PAGE_SIZE));
+  }
+}
+
+TEST(DiskManagerTest, CompressedPageTest) {
+  std::string db_name = "disk_compressed_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, true);
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(i, disk_mgr->AllocatePage());
+  }
+  alignas(PAGE_SIZE) char data[PAGE_SIZE];
+  std::mt19937 random(3);
+  // even pages compress, odd pages are random and are stored as is
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+      data[i] = page_id % 2 == 0 ? static_cast<char>('a' + page_id + i / 512) : static_cast<char>(random());
+    }
+    disk_mgr->WritePage(page_id, data, true);
+  }
+  // a compressed page overwritten without compression, and the other way round
+  memset(data, 'z', PAGE_SIZE);
+  disk_mgr->WritePage(2, data);
+  disk_mgr->WritePage(3, data, true);
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  random.seed(3);
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    std::vector<char> expected(PAGE_SIZE);
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+      expected[i] = page_id % 2 == 0 ? static_cast<char>('a' + page_id + i / 512) : static_cast<char>(random());
+    }
+    if (page_id == 2 || page_id == 3) {
+      expected.assign(PAGE_SIZE, 'z');
+    }
+    bool compressed = disk_mgr->ReadPage(page_id, data);
+    EXPECT_EQ(page_id == 3 || (page_id % 2 == 0 && page_id != 2), compressed);
+    EXPECT_EQ(expected, std::vector<char>(data, data + PAGE_SIZE));
+  }
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ReclaimSpaceTest) {
+  std::string db_name = "disk_reclaim_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  const page_id_t num_pages = 100;
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    EXPECT_EQ(page_id, disk_mgr->AllocatePage());
+    memset(data, 'a' + page_id % 26, PAGE_SIZE);
+    disk_mgr->WritePage(page_id, data);
+  }
+  disk_mgr->FlushMetadata();
+  struct stat before;
+  ASSERT_EQ(0, stat(db_name.c_str(), &before));
+  // a hole in the middle and the tail
+  for (page_id_t page_id = 10; page_id < 20; page_id++) {
+    disk_mgr->DeAllocatePage(page_id);
+  }
+  for (page_id_t page_id = 50; page_id < num_pages; page_id++) {
+    disk_mgr->DeAllocatePage(page_id);
+  }
+  disk_mgr->ReclaimSpace();
+  struct stat after;
+  ASSERT_EQ(0, stat(db_name.c_str(), &after));
+  // the meta page, the bitmap page and pages 0 to 49
+  EXPECT_EQ(52 * PAGE_SIZE, after.st_size);
+  EXPECT_LT(after.st_blocks, before.st_blocks);
+  disk_mgr->ReadPage(15, data);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(data, data + PAGE_SIZE));
+  disk_mgr->ReadPage(49, data);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'a' + 49 % 26), std::vector<char>(data, data + PAGE_SIZE));
+  // freed pages are allocated and written again as usual, past the end of the file too
+  page_id_t reused = disk_mgr->AllocatePage();
+  EXPECT_TRUE((reused >= 10 && reused < 20) || reused >= 50);
+  memset(data, 'z', PAGE_SIZE);
+  disk_mgr->WritePage(reused, data);
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_FALSE(disk_mgr->IsPageFree(reused));
+  EXPECT_FALSE(disk_mgr->IsPageFree(49));
+  for (page_id_t page_id = 10; page_id < num_pages; page_id++) {
+    EXPECT_EQ(page_id != reused && (page_id < 20 || page_id >= 50), disk_mgr->IsPageFree(page_id));
+  }
+  disk_mgr->ReadPage(reused, data);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'z'), std::vector<char>(data, data + PAGE_SIZE));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ReclaimSpaceAfterEmptyExtentTest) {
+  std::string db_name = "disk_reclaim_extent_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  const page_id_t num_pages = 2 * DiskManager::BITMAP_SIZE + 10;
+  const page_id_t live_page = 2 * DiskManager::BITMAP_SIZE + 5;
+  const page_id_t middle_extent_end = 2 * DiskManager::BITMAP_SIZE;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    ASSERT_EQ(page_id, disk_mgr->AllocatePage());
+  }
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  disk_mgr->WritePage(live_page, data);
+  // the middle extent empties, the meta page then counts fewer extents than the highest one in use
+  for (page_id_t page_id = DiskManager::BITMAP_SIZE; page_id < middle_extent_end; page_id++) {
+    disk_mgr->DeAllocatePage(page_id);
+  }
+  disk_mgr->ReclaimSpace();
+  EXPECT_FALSE(disk_mgr->IsPageFree(live_page));
+  disk_mgr->ReadPage(live_page, data);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'x'), std::vector<char>(data, data + PAGE_SIZE));
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_FALSE(disk_mgr->IsPageFree(live_page));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE));
+  disk_mgr->ReadPage(live_page, data);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'x'), std::vector<char>(data, data + PAGE_SIZE));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,174 @@
+#include "storage/free_space_map.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk_manager.h"
+
+TEST(FreeSpaceMapTest, FindUpdateAndReopen) {
+  const std::string db_name = "free_space_map_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  // more pages than one map page holds, with made up page ids and free spaces
+  const size_t num_pages = 2 * FreeSpacePage::CAPACITY + 10;
+  page_id_t first_page_id;
+  {
+    FreeSpaceMap map(bpm);
+    EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(1));
+    EXPECT_EQ(INVALID_PAGE_ID, map.GetLastPageId());
+    for (size_t i = 0; i < num_pages; i++) {
+      map.AddPage(1000 + i, i % 100);
+    }
+    first_page_id = map.GetFirstPageId();
+    ASSERT_NE(INVALID_PAGE_ID, first_page_id);
+    EXPECT_EQ(num_pages, map.GetPageCount());
+    // the first page with enough room
+    EXPECT_EQ(1000 + 50, map.FindPage(50));
+    EXPECT_EQ(1000 + 99, map.FindPage(99));
+    EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(100));
+    map.UpdatePage(1000 + 50, 10);
+    EXPECT_EQ(1000 + 51, map.FindPage(50));
+    map.UpdatePage(1000 + num_pages - 1, 500);
+    EXPECT_EQ(1000 + num_pages - 1, map.FindPage(100));
+    map.RemovePage(1000 + num_pages - 1);
+    EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(100));
+    EXPECT_EQ(1000 + num_pages - 2, map.GetLastPageId());
+  }
+
+  // Scenario: the map reads back as it was left.
+  {
+    FreeSpaceMap map(bpm, first_page_id);
+    EXPECT_EQ(num_pages - 1, map.GetPageCount());
+    EXPECT_EQ(1000 + 51, map.FindPage(50));
+    EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(100));
+    EXPECT_EQ(1000 + num_pages - 2, map.GetLastPageId());
+    map.AddPage(5, 200);
+    EXPECT_EQ(5, map.FindPage(100));
+    EXPECT_EQ(5, map.GetLastPageId());
+    map.Destroy();
+    EXPECT_EQ(INVALID_PAGE_ID, map.GetFirstPageId());
+  }
+  EXPECT_TRUE(bpm->IsPageFree(first_page_id));
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+/** @return the pages of the map's chain */
+static std::vector<page_id_t> GetMapPageIds(BufferPoolManager *bpm, page_id_t first_page_id) {
+  std::vector<page_id_t> map_page_ids;
+  for (page_id_t map_page_id = first_page_id; map_page_id != INVALID_PAGE_ID;) {
+    map_page_ids.push_back(map_page_id);
+    auto *page = reinterpret_cast<FreeSpacePage *>(bpm->FetchPage(map_page_id)->GetData());
+    page_id_t next_page_id = page->next_page_id_;
+    bpm->UnpinPage(map_page_id, false);
+    map_page_id = next_page_id;
+  }
+  return map_page_ids;
+}
+
+TEST(FreeSpaceMapTest, RemovedEntriesAreReused) {
+  const std::string db_name = "free_space_map_reuse_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  const size_t num_pages = 3 * FreeSpacePage::CAPACITY;
+  FreeSpaceMap map(bpm);
+  for (size_t i = 0; i < num_pages; i++) {
+    ASSERT_TRUE(map.AddPage(1000 + i, 10));
+  }
+  page_id_t first_page_id = map.GetFirstPageId();
+  std::vector<page_id_t> old_map_page_ids = GetMapPageIds(bpm, first_page_id);
+  ASSERT_EQ(3, old_map_page_ids.size());
+
+  // keep every fourth page, the map is compacted on the way and keeps its order and its first page
+  size_t last_kept = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    if (i % 4 == 0) {
+      last_kept = i;
+    } else {
+      ASSERT_TRUE(map.RemovePage(1000 + i));
+    }
+  }
+  EXPECT_EQ((num_pages + 3) / 4, map.GetPageCount());
+  EXPECT_EQ(first_page_id, map.GetFirstPageId());
+  std::vector<page_id_t> map_page_ids = GetMapPageIds(bpm, first_page_id);
+  EXPECT_LE(map_page_ids.size(), 2);
+  for (page_id_t map_page_id : old_map_page_ids) {
+    bool in_chain = std::find(map_page_ids.begin(), map_page_ids.end(), map_page_id) != map_page_ids.end();
+    EXPECT_NE(in_chain, bpm->IsPageFree(map_page_id));
+  }
+  EXPECT_EQ(1000, map.FindPage(10));
+  ASSERT_TRUE(map.UpdatePage(1000 + 8, 50));
+  EXPECT_EQ(1000 + 8, map.FindPage(50));
+  EXPECT_EQ(1000 + last_kept, map.GetLastPageId());
+
+  // Scenario: pages that come and go do not grow the chain.
+  for (int round = 0; round < 10; round++) {
+    for (size_t i = 0; i < num_pages; i++) {
+      ASSERT_TRUE(map.AddPage(100000 + i, 20));
+    }
+    for (size_t i = 0; i < num_pages; i++) {
+      ASSERT_TRUE(map.RemovePage(100000 + i));
+    }
+  }
+  EXPECT_LE(GetMapPageIds(bpm, first_page_id).size(), 2);
+
+  // Scenario: the compacted map reads back as it was left.
+  {
+    FreeSpaceMap reopened(bpm, first_page_id);
+    ASSERT_TRUE(reopened.IsLoaded());
+    EXPECT_EQ((num_pages + 3) / 4, reopened.GetPageCount());
+    EXPECT_EQ(1000 + 8, reopened.FindPage(50));
+    EXPECT_EQ(INVALID_PAGE_ID, reopened.FindPage(51));
+    EXPECT_EQ(1000 + last_kept, reopened.GetLastPageId());
+  }
+  map.Destroy();
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(FreeSpaceMapTest, FullBufferPoolLeavesMapUnchanged) {
+  const std::string db_name = "free_space_map_full_pool_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  const size_t pool_size = 8;
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+  std::vector<page_id_t> pinned(pool_size);
+  for (size_t i = 0; i < pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(pinned[i]));
+  }
+  FreeSpaceMap map(bpm);
+  EXPECT_FALSE(map.AddPage(1000, 100));
+  EXPECT_EQ(0, map.GetPageCount());
+  EXPECT_EQ(INVALID_PAGE_ID, map.GetFirstPageId());
+
+  bpm->UnpinPage(pinned.back(), false);
+  ASSERT_TRUE(map.AddPage(1000, 100));
+  page_id_t first_page_id = map.GetFirstPageId();
+  // the map's page is evicted for a pinned page again
+  ASSERT_NE(nullptr, bpm->FetchPage(pinned.back()));
+  EXPECT_FALSE(map.UpdatePage(1000, 10));
+  EXPECT_FALSE(map.AddPage(1001, 100));
+  EXPECT_FALSE(map.RemovePage(1000));
+  EXPECT_EQ(1, map.GetPageCount());
+  EXPECT_EQ(1000, map.FindPage(100));
+  EXPECT_FALSE(FreeSpaceMap(bpm, first_page_id).IsLoaded());
+
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+  FreeSpaceMap reopened(bpm, first_page_id);
+  ASSERT_TRUE(reopened.IsLoaded());
+  EXPECT_EQ(1, reopened.GetPageCount());
+  EXPECT_EQ(1000, reopened.FindPage(100));
+  EXPECT_TRUE(map.RemovePage(1000));
+  EXPECT_EQ(INVALID_PAGE_ID, map.GetLastPageId());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+#include "utils/utils.h"
+
+/**
+ * Page size micro benchmark. PAGE_SIZE is a build option, so this reports the numbers of one page size; building
+ * with -DMINISQL_PAGE_SIZE=4096, 8192, 16384 or 32768 and running it for each gives the comparison.
+ */
+
+TEST(PageSizeBenchmark, WideKeyIndexAndTableScan) {
+  const std::string db_name = "page_size_bench.db";
+  const int num_keys = 50000;
+  const int num_rows = 20000;
+  remove(db_name.c_str());
+
+  // wide CHAR keys, inserted in random order
+  std::vector<Column *> key_columns = {new Column("name", TypeId::kTypeChar, 48, 0, false, false)};
+  Schema *key_schema = new Schema(key_columns);
+  KeyManager key_manager(key_schema, 64);
+  std::vector<int> order(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  std::vector<GenericKey *> keys(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    char name[48];
+    snprintf(name, sizeof(name), "customer-%038d", i);
+    keys[i] = key_manager.InitKey();
+    Fields fields{Field(TypeId::kTypeChar, name, sizeof(name) - 1, true)};
+    key_manager.SerializeFromKey(keys[i], Row(fields), key_schema);
+  }
+  // a table of 100 byte rows
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("payload", TypeId::kTypeChar, 96, 1, false, false)};
+  Schema *schema = new Schema(columns);
+  char payload[96];
+  memset(payload, 'p', sizeof(payload));
+  SimpleMemHeap heap;
+
+  // load both with a pool that holds them
+  auto *engine = new DBStorageEngine(db_name, true, DEFAULT_BUFFER_POOL_SIZE, true);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(engine->disk_mgr_->GetMetaData());
+  uint32_t pages_before = meta_page->GetAllocatedPages();
+  double insert_seconds;
+  {
+    BPlusTree tree(0, engine->bpm_, key_manager);
+    auto start = std::chrono::steady_clock::now();
+    for (int i : order) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    }
+    insert_seconds = SecondsSince(start);
+  }
+  uint32_t index_pages = meta_page->GetAllocatedPages() - pages_before;
+  auto *table = TableHeap::Create(engine->bpm_, schema, nullptr, nullptr, nullptr, &heap);
+  page_id_t first_page_id = table->GetFirstPageId();
+  for (int i = 0; i < num_rows; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, payload, sizeof(payload), false)};
+    Row row(fields);
+    ASSERT_TRUE(table->InsertTuple(row, nullptr));
+  }
+  delete engine;
+
+  // then measure through a pool much smaller than either, with direct I/O so that misses go to the file
+  engine = new DBStorageEngine(db_name, false, 256, true);
+  BPlusTree tree(0, engine->bpm_, key_manager);
+  std::mt19937 random(7);
+  std::vector<RowId> result;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_keys; i++) {
+    result.clear();
+    ASSERT_TRUE(tree.GetValue(keys[random() % num_keys], result));
+  }
+  double lookup_seconds = SecondsSince(start);
+  table = TableHeap::Create(engine->bpm_, first_page_id, schema, nullptr, nullptr, &heap);
+  int rows = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto iter = table->Begin(nullptr); iter != table->End(); ++iter) {
+    rows++;
+  }
+  double scan_seconds = SecondsSince(start);
+  EXPECT_EQ(num_rows, rows);
+
+  std::cout << "[bench] page size=" << PAGE_SIZE << " index pages=" << index_pages
+            << " inserts/s=" << static_cast<uint64_t>(num_keys / insert_seconds)
+            << " cold lookups/s=" << static_cast<uint64_t>(num_keys / lookup_seconds)
+            << " cold scan rows/s=" << static_cast<uint64_t>(rows / scan_seconds) << std::endl;
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete engine;
+  delete key_schema;
+  delete schema;
+  remove(db_name.c_str());
+}
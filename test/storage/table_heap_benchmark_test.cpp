@@ -0,0 +1,372 @@
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/heap.h"
+#include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "record/field.h"
+#include "record/row_view.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+#include "utils/utils.h"
+
+/** Table heap micro benchmarks. */
+
+TEST(TableHeapBenchmark, ColdScanAfterInterleavedInserts) {
+  const std::string db_name = "table_heap_bench.db";
+  const int num_tables = 4;
+  const int rows_per_table = 4000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("payload", TypeId::kTypeChar, 400, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char payload[400];
+  memset(payload, 'p', sizeof(payload));
+
+  for (uint32_t run_pages : {0, DEFAULT_ALLOCATION_RUN_PAGES}) {
+    SimpleMemHeap heap;
+    remove(db_name.c_str());
+    // direct I/O keeps the kernel page cache from hiding where the pages are
+    auto *disk_manager = new DiskManager(db_name, true);
+    disk_manager->SetAllocationRunPages(run_pages);
+    std::vector<page_id_t> first_page_ids;
+    {
+      BufferPoolManager bpm(DEFAULT_BUFFER_POOL_SIZE, disk_manager);
+      // the tables grow side by side, like tables that are loaded at the same time
+      std::vector<TableHeap *> tables;
+      for (int t = 0; t < num_tables; t++) {
+        tables.push_back(TableHeap::Create(&bpm, schema.get(), nullptr, nullptr, nullptr, &heap));
+        first_page_ids.push_back(tables.back()->GetFirstPageId());
+      }
+      for (int i = 0; i < rows_per_table; i++) {
+        for (auto *table : tables) {
+          Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, payload, sizeof(payload), false)};
+          Row row(fields);
+          ASSERT_TRUE(table->InsertTuple(row, nullptr));
+        }
+      }
+    }
+    double fragmentation;
+    {
+      BufferPoolManager bpm(64, disk_manager);
+      fragmentation = TableHeap::Create(&bpm, first_page_ids[0], schema.get(), nullptr, nullptr, &heap)
+                          ->GetFragmentation();
+    }
+    // a small pool that starts out empty, so every page of the scan is read from the file
+    int rows = 0;
+    double seconds;
+    {
+      BufferPoolManager bpm(64, disk_manager);
+      auto *table = TableHeap::Create(&bpm, first_page_ids[0], schema.get(), nullptr, nullptr, &heap);
+      auto start = std::chrono::steady_clock::now();
+      for (auto iter = table->Begin(nullptr); iter != table->End(); ++iter) {
+        rows++;
+      }
+      seconds = SecondsSince(start);
+    }
+    std::cout << "[bench] allocation run pages=" << std::setw(2) << run_pages << " fragmentation=" << std::fixed
+              << std::setprecision(3) << fragmentation << " cold scan rows/s=" << static_cast<uint64_t>(rows / seconds)
+              << std::endl;
+    EXPECT_EQ(rows_per_table, rows);
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapBenchmark, SustainedInsertsIntoLargeTable) {
+  const std::string db_name = "table_heap_insert_bench.db";
+  const int num_rows = 1000000;
+  const int rows_per_segment = 200000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char name[32];
+  memset(name, 'n', sizeof(name));
+  SimpleMemHeap heap;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    // much smaller than the table, so that inserts keep evicting pages
+    BufferPoolManager bpm(1024, disk_manager);
+    auto *table = TableHeap::Create(&bpm, schema.get(), nullptr, nullptr, nullptr, &heap);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_rows; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), false)};
+      Row row(fields);
+      ASSERT_TRUE(table->InsertTuple(row, nullptr));
+      // the rate of each segment shows whether inserts slow down as the table grows
+      if ((i + 1) % rows_per_segment == 0) {
+        std::cout << "[bench] insert rows " << std::setw(7) << i + 1 - rows_per_segment << " to " << std::setw(7)
+                  << i + 1 << " inserts/s=" << static_cast<uint64_t>(rows_per_segment / SecondsSince(start))
+                  << std::endl;
+        start = std::chrono::steady_clock::now();
+      }
+    }
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapBenchmark, BulkAppendVersusInsert) {
+  const std::string db_name = "table_heap_append_bench.db";
+  const int num_rows = 200000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char name[32];
+  memset(name, 'n', sizeof(name));
+
+  for (bool append : {false, true}) {
+    SimpleMemHeap heap;
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    {
+      BufferPoolManager bpm(1024, disk_manager);
+      auto *table = TableHeap::Create(&bpm, schema.get(), nullptr, nullptr, nullptr, &heap);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_rows; i++) {
+        Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), false)};
+        Row row(fields);
+        ASSERT_TRUE(append ? table->AppendTuple(row, nullptr) : table->InsertTuple(row, nullptr));
+      }
+      table->EndAppend();
+      std::cout << "[bench] load " << num_rows << " rows with " << (append ? "AppendTuple" : "InsertTuple")
+                << " inserts/s=" << static_cast<uint64_t>(num_rows / SecondsSince(start)) << std::endl;
+      EXPECT_TRUE(bpm.CheckAllUnpinned());
+    }
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+}
+
+TEST(TableHeapBenchmark, ScanAfterDeleteChurn) {
+  const std::string db_name = "table_heap_vacuum_bench.db";
+  const int num_rows = 200000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("payload", TypeId::kTypeChar, 96, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char payload[96];
+  memset(payload, 'p', sizeof(payload));
+  SimpleMemHeap heap;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    BufferPoolManager bpm(1024, disk_manager);
+    auto *table = TableHeap::Create(&bpm, schema.get(), nullptr, nullptr, nullptr, &heap);
+    std::vector<RowId> row_ids;
+    for (int i = 0; i < num_rows; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, payload, sizeof(payload), false)};
+      Row row(fields);
+      ASSERT_TRUE(table->AppendTuple(row, nullptr));
+      row_ids.push_back(row.GetRowId());
+    }
+    table->EndAppend();
+    // churn: delete the oldest nine rows out of ten, like a table that keeps only its recent history
+    for (int i = 0; i < num_rows - num_rows / 10; i++) {
+      ASSERT_TRUE(table->MarkDelete(row_ids[i], nullptr));
+    }
+    auto scan = [&](const char *label) {
+      auto start = std::chrono::steady_clock::now();
+      int rows = 0;
+      for (auto iter = table->Begin(nullptr); iter != table->End(); ++iter) {
+        rows++;
+      }
+      double seconds = SecondsSince(start);
+      EXPECT_EQ(num_rows / 10, rows);
+      std::cout << "[bench] scan " << label << " ms=" << seconds * 1000
+                << " rows/s=" << static_cast<uint64_t>(rows / seconds) << std::endl;
+    };
+    scan("before vacuum");
+    auto start = std::chrono::steady_clock::now();
+    VacuumStats stats = table->Vacuum();
+    std::cout << "[bench] vacuum ms=" << SecondsSince(start) * 1000 << " pages scanned=" << stats.pages_scanned_
+              << " tuples removed=" << stats.tuples_removed_ << " KB reclaimed=" << stats.bytes_reclaimed_ / 1024
+              << " pages freed=" << stats.pages_freed_ << std::endl;
+    EXPECT_EQ(num_rows - num_rows / 10, stats.tuples_removed_);
+    scan("after vacuum");
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapBenchmark, SmallTupleChurnOnOnePage) {
+  const int num_ops = 200000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto page = std::make_unique<TablePage>();
+  page->Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  // fill the page with small tuples
+  std::vector<RowId> row_ids;
+  for (int i = 0;; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    if (!page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) {
+      break;
+    }
+    row_ids.push_back(row.GetRowId());
+  }
+  // then keep replacing random ones: a delete and an insert per operation
+  std::mt19937 rng(42);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_ops; i++) {
+    size_t victim = rng() % row_ids.size();
+    ASSERT_TRUE(page->MarkDelete(row_ids[victim], nullptr, nullptr, nullptr));
+    page->ApplyDelete(row_ids[victim], nullptr, nullptr);
+    Fields fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_TRUE(page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+    row_ids[victim] = row.GetRowId();
+  }
+  std::cout << "[bench] page size=" << PAGE_SIZE << " tuples per page=" << row_ids.size()
+            << " delete+insert ops/s=" << static_cast<uint64_t>(num_ops / SecondsSince(start)) << std::endl;
+}
+
+TEST(TableHeapBenchmark, WarmFullScan) {
+  const std::string db_name = "table_heap_scan_bench.db";
+  const int num_rows = 200000;
+  const int num_scans = 5;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char name[16];
+  memset(name, 'n', sizeof(name));
+  SimpleMemHeap heap;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    // the pool holds the whole table, the scans measure the per row cost of the iterator alone
+    BufferPoolManager bpm(4096, disk_manager);
+    auto *table = TableHeap::Create(&bpm, schema.get(), nullptr, nullptr, nullptr, &heap);
+    for (int i = 0; i < num_rows; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), false)};
+      Row row(fields);
+      ASSERT_TRUE(table->AppendTuple(row, nullptr));
+    }
+    table->EndAppend();
+    uint64_t fetches = bpm.GetHitCount() + bpm.GetMissCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < num_scans; scan++) {
+      int rows = 0;
+      for (auto iter = table->Begin(nullptr); iter != table->End(); ++iter) {
+        rows++;
+      }
+      ASSERT_EQ(num_rows, rows);
+    }
+    double seconds = SecondsSince(start);
+    fetches = bpm.GetHitCount() + bpm.GetMissCount() - fetches;
+    std::cout << "[bench] full scan of " << num_rows << " rows ms=" << seconds * 1000 / num_scans
+              << " rows/s=" << static_cast<uint64_t>(num_rows * num_scans / seconds)
+              << " page fetches per row=" << static_cast<double>(fetches) / (num_rows * num_scans) << std::endl;
+    EXPECT_TRUE(bpm.CheckAllUnpinned());
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapBenchmark, PredicateScanOnRowsVersusRowViews) {
+  const std::string db_name = "table_heap_predicate_bench.db";
+  const int num_rows = 200000;
+  const int num_scans = 3;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, false, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char name[32];
+  memset(name, 'n', sizeof(name));
+  SimpleMemHeap heap;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    BufferPoolManager bpm(4096, disk_manager);
+    auto *table = TableHeap::Create(&bpm, schema.get(), nullptr, nullptr, nullptr, &heap);
+    int expected = 0;
+    for (int i = 0; i < num_rows; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 8 + i % 24, false),
+                    Field(TypeId::kTypeFloat, static_cast<float>(i % 100))};
+      Row row(fields);
+      ASSERT_TRUE(table->AppendTuple(row, nullptr));
+      expected += i % 100 == 42 && 8 + i % 24 > 24;
+    }
+    table->EndAppend();
+    // account = 42 and name > 24 times 'n', a filter that keeps few rows and reads past the CHAR column
+    auto account = std::make_shared<ColumnValueExpression>(0, 2, TypeId::kTypeFloat);
+    auto name_col = std::make_shared<ColumnValueExpression>(0, 1, TypeId::kTypeChar);
+    ComparisonExpression on_account(account, std::make_shared<ConstantValueExpression>(Field(kTypeFloat, 42.0f)), "=");
+    ComparisonExpression on_name(name_col, std::make_shared<ConstantValueExpression>(Field(kTypeChar, name, 24, true)),
+                                 ">");
+    Field true_field(kTypeInt, 1);
+    for (bool view : {false, true}) {
+      int matches = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int scan = 0; scan < num_scans; scan++) {
+        for (auto iter = table->Begin(nullptr); iter != table->End(); ++iter) {
+          bool match = view ? true_field.CompareEquals(on_account.Evaluate(iter.GetRowView())) == kTrue &&
+                                  true_field.CompareEquals(on_name.Evaluate(iter.GetRowView())) == kTrue
+                            : true_field.CompareEquals(on_account.Evaluate(iter.GetRow())) == kTrue &&
+                                  true_field.CompareEquals(on_name.Evaluate(iter.GetRow())) == kTrue;
+          matches += match;
+        }
+      }
+      double seconds = SecondsSince(start);
+      EXPECT_EQ(num_scans * expected, matches);
+      std::cout << "[bench] predicate scan on " << (view ? "RowView" : "Row    ")
+                << " rows/s=" << static_cast<uint64_t>(num_rows * num_scans / seconds) << std::endl;
+    }
+    EXPECT_TRUE(bpm.CheckAllUnpinned());
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapBenchmark, LastColumnAccessByRowFormat) {
+  const int num_rows = 100000;
+  const int num_passes = 10;
+  // a wide row: CHAR and INT columns taking turns, the one read is the last
+  std::vector<Column *> columns;
+  for (uint32_t i = 0; i < 16; i++) {
+    columns.push_back(i % 2 == 0 ? new Column("c" + std::to_string(i), TypeId::kTypeChar, 16, i, false, false)
+                                 : new Column("c" + std::to_string(i), TypeId::kTypeInt, i, false, false));
+  }
+  Schema schema(columns);
+  char chars[16];
+  memset(chars, 'c', sizeof(chars));
+  std::vector<std::vector<char>> v1_rows, v2_rows;
+  for (int i = 0; i < num_rows; i++) {
+    Fields fields;
+    for (uint32_t k = 0; k < columns.size(); k++) {
+      fields.push_back(k % 2 == 0 ? Field(TypeId::kTypeChar, chars, 1 + (i + k) % 16, false)
+                                  : Field(TypeId::kTypeInt, i));
+    }
+    Row row(fields);
+    v2_rows.emplace_back(row.GetSerializedSize(&schema));
+    row.SerializeTo(v2_rows.back().data(), &schema);
+    // format v1: field count, null bitmap, the fields packed one after the other
+    v1_rows.emplace_back(sizeof(uint32_t) + Row::GetNullBitmapSize(columns.size()), '\xff');
+    MACH_WRITE_UINT32(v1_rows.back().data(), columns.size());
+    for (auto &field : fields) {
+      size_t offset = v1_rows.back().size();
+      v1_rows.back().resize(offset + field.GetSerializedSize());
+      field.SerializeTo(v1_rows.back().data() + offset);
+    }
+  }
+  for (auto *rows : {&v1_rows, &v2_rows}) {
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < num_passes; pass++) {
+      for (auto &row : *rows) {
+        sum += RowView(row.data(), &schema).GetInt(columns.size() - 1);
+      }
+    }
+    double seconds = SecondsSince(start);
+    EXPECT_EQ(static_cast<int64_t>(num_passes) * num_rows * (num_rows - 1) / 2, sum);
+    std::cout << "[bench] read column 16 of 16 in row format " << (rows == &v1_rows ? "v1" : "v2")
+              << " rows/s=" << static_cast<uint64_t>(num_rows * num_passes / seconds) << std::endl;
+  }
+}
+
@@ -63,3 +63,455 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   ASSERT_EQ(size, 0);
 }
 
+
+TEST(TableHeapTest, TableHeapScanRingTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_ring_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(64, disk_mgr_);
+  const int row_nums = 5000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+
+  // Scenario: a scan through a private ring returns every row in insertion order and leaves no page pinned.
+  {
+    BufferAccessStrategy strategy(bpm_, 4);
+    int expected = 0;
+    for (auto iter = table_heap->Begin(nullptr, &strategy); iter != table_heap->End(); ++iter) {
+      ASSERT_EQ(expected, iter->GetField(0)->value_.integer_);
+      expected++;
+    }
+    EXPECT_EQ(row_nums, expected);
+  }
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableHeapCompressionTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_compression_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(16, disk_mgr_);
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  table_heap->SetCompression(true);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  delete bpm_;
+  delete disk_mgr_;
+
+  // Scenario: the pages, evicted through a small pool and then read back, keep their rows and the heap its mode.
+  disk_mgr_ = new DiskManager(db_name);
+  bpm_ = new BufferPoolManager(16, disk_mgr_);
+  table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+  EXPECT_TRUE(table_heap->IsCompressed());
+  for (int i = 0; i < row_nums; i++) {
+    Row row(row_ids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i, row.GetField(0)->value_.integer_);
+  }
+
+  // Scenario: turning compression off rewrites the pages uncompressed.
+  table_heap->SetCompression(false);
+  delete bpm_;
+  delete disk_mgr_;
+  disk_mgr_ = new DiskManager(db_name);
+  bpm_ = new BufferPoolManager(16, disk_mgr_);
+  table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+  EXPECT_FALSE(table_heap->IsCompressed());
+  int rows = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    rows++;
+  }
+  EXPECT_EQ(row_nums, rows);
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableHeapFreeSpaceReuseTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_free_space_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(64, disk_mgr_);
+  const int row_nums = 2020;  // leaves room on the last page
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  // free a few rows of the page in the middle of the heap
+  page_id_t middle_page_id = row_ids[row_nums / 2].GetPageId();
+  std::vector<RowId> deleted;
+  for (auto &rid : row_ids) {
+    if (rid.GetPageId() == middle_page_id && deleted.size() < 3) {
+      ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+      table_heap->ApplyDelete(rid, nullptr);
+      deleted.push_back(rid);
+    }
+  }
+  delete bpm_;
+  delete disk_mgr_;
+
+  // Scenario: after reopening, new rows fill the freed space instead of going to the last page.
+  disk_mgr_ = new DiskManager(db_name);
+  bpm_ = new BufferPoolManager(64, disk_mgr_);
+  table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+  for (size_t i = 0; i < deleted.size(); i++) {
+    Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    EXPECT_EQ(middle_page_id, row.GetRowId().GetPageId());
+  }
+  // the next one goes to the end again
+  Fields fields{Field(TypeId::kTypeInt, -2), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  EXPECT_EQ(row_ids.back().GetPageId(), row.GetRowId().GetPageId());
+
+  int rows = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    rows++;
+  }
+  EXPECT_EQ(row_nums + 1, rows);
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableHeapFullBufferPoolTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_full_pool_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  const size_t pool_size = 8;
+  auto bpm_ = new BufferPoolManager(pool_size, disk_mgr_);
+  // one row fills a page
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 3000, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[3000];
+  memset(characters, 'a', sizeof(characters));
+  Fields fields{Field(TypeId::kTypeInt, 0), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+
+  // Scenario: the heap's first page and its free space map page are the only frames left, so the map can not record
+  // a new page; the insert fails and leaves the heap as it was.
+  std::vector<page_id_t> pinned(pool_size - 2);
+  for (auto &page_id : pinned) {
+    ASSERT_NE(nullptr, bpm_->NewPage(page_id));
+  }
+  Row failed_row(fields);
+  EXPECT_FALSE(table_heap->InsertTuple(failed_row, nullptr));
+  // the row got as far as a new page, which was freed again
+  ASSERT_NE(INVALID_PAGE_ID, failed_row.GetRowId().GetPageId());
+  EXPECT_TRUE(bpm_->IsPageFree(failed_row.GetRowId().GetPageId()));
+  for (auto page_id : pinned) {
+    bpm_->UnpinPage(page_id, false);
+  }
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  Row next_row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(next_row, nullptr));
+  int rows = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    rows++;
+  }
+  EXPECT_EQ(2, rows);
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableHeapRemovePinnedPageTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_remove_pinned_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(64, disk_mgr_);
+  // one row fills a page
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 3000, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[3000];
+  memset(characters, 'a', sizeof(characters));
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < 3; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  page_id_t middle_page_id = row_ids[1].GetPageId();
+
+  // Scenario: the middle page empties while a scan has it pinned. It leaves the heap at once, the scan still finds
+  // its way on, and the page is deleted by the next vacuum.
+  {
+    auto iter = table_heap->Begin(nullptr);
+    ++iter;
+    ASSERT_EQ(row_ids[1].Get(), iter->GetRowId().Get());
+    ASSERT_TRUE(table_heap->MarkDelete(row_ids[1], nullptr));
+    table_heap->ApplyDelete(row_ids[1], nullptr);
+    EXPECT_FALSE(bpm_->IsPageFree(middle_page_id));
+    ++iter;
+    ASSERT_TRUE(iter != table_heap->End());
+    EXPECT_TRUE(iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 2)));
+  }
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+  std::vector<int64_t> scanned;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    scanned.push_back(iter->GetRowId().Get());
+  }
+  EXPECT_EQ((std::vector<int64_t>{row_ids[0].Get(), row_ids[2].Get()}), scanned);
+
+  EXPECT_FALSE(bpm_->IsPageFree(middle_page_id));
+  table_heap->Vacuum();
+  EXPECT_TRUE(bpm_->IsPageFree(middle_page_id));
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableHeapAppendTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_append_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(64, disk_mgr_);
+  const int row_nums = 2020;  // leaves room on the last page
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // free a few rows of the first page, appends must not go there
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(table_heap->MarkDelete(row_ids[i], nullptr));
+    table_heap->ApplyDelete(row_ids[i], nullptr);
+  }
+
+  // appends fill the last page, then continue on new pages linked after it
+  page_id_t last_page_id = row_ids.back().GetPageId();
+  std::unordered_map<int64_t, int> appended;
+  for (int i = row_nums; i < 2 * row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->AppendTuple(row, nullptr));
+    ASSERT_NE(row_ids[0].GetPageId(), row.GetRowId().GetPageId());
+    if (i == row_nums) {
+      EXPECT_EQ(last_page_id, row.GetRowId().GetPageId());
+    }
+    appended[row.GetRowId().Get()] = i;
+  }
+  // the last page stays pinned until the append ends
+  EXPECT_FALSE(bpm_->CheckAllUnpinned());
+  table_heap->EndAppend();
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  // the free space map knows the appended pages, an insert still finds the freed space
+  Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  EXPECT_EQ(row_ids[0].GetPageId(), row.GetRowId().GetPageId());
+
+  // every appended row survives eviction and is found by a scan
+  int rows = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    auto it = appended.find(iter->GetRowId().Get());
+    if (it != appended.end()) {
+      ASSERT_TRUE(iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, it->second)));
+      appended.erase(it);
+    }
+    rows++;
+  }
+  EXPECT_TRUE(appended.empty());
+  EXPECT_EQ(2 * row_nums - 3 + 1, rows);
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableHeapVacuumTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_heap_vacuum_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(64, disk_mgr_);
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  std::vector<RowId> row_ids;
+  uint32_t row_size = 0;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    row_size = row.GetSerializedSize(schema.get());
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // delete every row of the first page and of a page in the middle, and every fourth row elsewhere
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  page_id_t middle_page_id = row_ids[row_nums / 2].GetPageId();
+  std::vector<bool> deleted(row_nums, false);
+  size_t deleted_count = 0;
+  for (int i = 0; i < row_nums; i++) {
+    page_id_t page_id = row_ids[i].GetPageId();
+    if (page_id == first_page_id || page_id == middle_page_id || i % 4 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(row_ids[i], nullptr));
+      deleted[i] = true;
+      deleted_count++;
+    }
+  }
+  // a tuple can be marked deleted only once
+  ASSERT_FALSE(table_heap->MarkDelete(row_ids[0], nullptr));
+  EXPECT_TRUE(table_heap->NeedsVacuum());
+
+  VacuumStats stats = table_heap->Vacuum();
+  EXPECT_EQ(deleted_count, stats.tuples_removed_);
+  EXPECT_EQ(1, stats.pages_freed_);
+  EXPECT_GE(stats.bytes_reclaimed_, deleted_count * row_size);
+  EXPECT_LE(stats.bytes_reclaimed_, deleted_count * (row_size + 8));
+  EXPECT_TRUE(bpm_->IsPageFree(middle_page_id));
+  EXPECT_FALSE(table_heap->NeedsVacuum());
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  // the scan steps over the empty first page and sees exactly the rows that were kept
+  std::unordered_map<int64_t, int> ids;
+  for (int i = 0; i < row_nums; i++) {
+    ids[row_ids[i].Get()] = i;
+  }
+  int rows = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    int id = ids.at(iter->GetRowId().Get());
+    ASSERT_FALSE(deleted[id]);
+    ASSERT_TRUE(iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+    rows++;
+  }
+  EXPECT_EQ(row_nums - deleted_count, rows);
+
+  // nothing is left to remove, and the freed space is reused from the first page on
+  EXPECT_EQ(0, table_heap->Vacuum().tuples_removed_);
+  Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  EXPECT_EQ(first_page_id, row.GetRowId().GetPageId());
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TableIteratorPinTest) {
+  SimpleMemHeap heap;
+  const std::string db_name = "table_iterator_pin_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(64, disk_mgr_);
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  // an empty heap begins at its end and pins nothing
+  EXPECT_TRUE(table_heap->Begin(nullptr) == table_heap->End());
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+
+  {
+    // the iterator holds one pin on the page of its row, copies hold their own
+    auto iter = table_heap->Begin(nullptr);
+    EXPECT_FALSE(bpm_->CheckAllUnpinned());
+    auto copy = iter;
+    auto post = iter++;
+    ASSERT_TRUE(post == copy);
+    ASSERT_TRUE(copy->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 0)));
+    ASSERT_TRUE(iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 1)));
+    copy = iter;
+    auto moved = std::move(post);
+    ASSERT_TRUE(moved->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 0)));
+    moved = table_heap->End();
+    ASSERT_TRUE(copy == iter);
+  }
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  // delete the rows behind the scan like DELETE does, emptying and freeing pages the scan has left
+  int rows = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End();) {
+    ASSERT_TRUE(iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rows)));
+    RowId rid = iter->GetRowId();
+    ++iter;
+    ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+    rows++;
+  }
+  EXPECT_EQ(row_nums, rows);
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+  EXPECT_TRUE(table_heap->Begin(nullptr) == table_heap->End());
+
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}